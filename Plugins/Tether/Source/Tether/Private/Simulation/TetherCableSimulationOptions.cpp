@@ -19,6 +19,32 @@ bool FTetherCableSimulationOptions::ShouldUseSelfCollision() const
 	return bEnableCollision && bEnableSelfCollision && CVarSelfCollision.GetValueOnAnyThread() > 0;
 }
 
+bool FTetherCableSimulationOptions::ShouldUseCollisionSnapshot() const
+{
+	return bEnableCollision && (bEnableCollisionSnapshot || CollisionMode == ETetherCollisionMode::DistanceField) && !ShouldUseSelfCollision();
+}
+
+bool FTetherCableSimulationOptions::ShouldUseDistanceField() const
+{
+	return ShouldUseCollisionSnapshot() && CollisionMode == ETetherCollisionMode::DistanceField;
+}
+
+bool FTetherCableSimulationOptions::ShouldUseCollisionCulling() const
+{
+	return bEnableCollision && bEnableCollisionCulling && CollisionCullingDistance > 0.f && !ShouldUseSelfCollision();
+}
+
+bool FTetherCableSimulationOptions::ShouldUseContactCaching() const
+{
+	return bEnableCollision && bEnableContactCaching && ContactCacheMargin > 0.f && !ShouldUseSelfCollision();
+}
+
+bool FTetherCableSimulationOptions::ShouldUseWarmStart(bool bRealtimeSimulating) const
+{
+	// Realtime simulation progresses from wherever the particles are, so there is no settle window to shorten
+	return bEnableWarmStart && !bRealtimeSimulating;
+}
+
 void FTetherCableSimulationOptions::CheckSelfCollisionOptions() const
 {
 	if(bEnableCollision && bEnableSelfCollision && CVarSelfCollision.GetValueOnAnyThread() < 1)
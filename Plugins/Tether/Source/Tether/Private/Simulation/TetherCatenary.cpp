@@ -0,0 +1,62 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#include "Simulation/TetherCatenary.h"
+#include <cmath>
+
+bool FTetherCatenary::Solve(const FVector& Start, const FVector& End, double Length, const FVector& CableForce, FTetherCatenary& OutCatenary)
+{
+	if(CableForce.IsNearlyZero())
+	{
+		return false;
+	}
+
+	const FVector Up = -CableForce.GetSafeNormal();
+	const FVector Chord = End - Start;
+
+	// Vertical and horizontal separation of the end points relative to the force
+	const double Rise = Chord.Dot(Up);
+	const FVector HorizontalChord = Chord - Rise * Up;
+	const double Span = HorizontalChord.Size();
+
+	if(Span < KINDA_SMALL_NUMBER || Length * Length <= Chord.SizeSquared() + KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Solve sinh(X) / X = Ratio for X = Span / (2 * CatenaryParam), where Ratio > 1 is how much longer the cable is than the span (ignoring rise)
+	// sinh(X) - Ratio * X is convex for positive X, so Newton's method converges monotonically from an initial guess above the root
+	// Both guesses are above the root: the first from the Taylor series of sinh, the second from sinh(X) >= exp(X) / 2 - 1 / 2
+	const double Ratio = FMath::Sqrt(Length * Length - Rise * Rise) / Span;
+	double X = FMath::Min(FMath::Sqrt(6.0 * (Ratio - 1.0)), 2.0 * FMath::Loge(2.0 * Ratio) + 1.0);
+	for(int32 Iteration = 0; Iteration < 64; Iteration++)
+	{
+		const double Step = (sinh(X) - Ratio * X) / (cosh(X) - Ratio);
+		X -= Step;
+		if(FMath::Abs(Step) < 1e-12 * X)
+		{
+			break;
+		}
+	}
+	if(!(X > 0.0))
+	{
+		return false;
+	}
+
+	// Height = CatenaryParam * cosh((Horizontal - Vertex) / CatenaryParam) - StartHeight, passing through (0, 0) and (Span, Rise)
+	OutCatenary.Start = Start;
+	OutCatenary.Up = Up;
+	OutCatenary.Across = HorizontalChord / Span;
+	OutCatenary.CatenaryParam = Span / (2.0 * X);
+	OutCatenary.Vertex = Span * 0.5 - OutCatenary.CatenaryParam * atanh(FMath::Clamp(Rise / Length, -1.0 + DOUBLE_SMALL_NUMBER, 1.0 - DOUBLE_SMALL_NUMBER));
+	OutCatenary.StartSinh = sinh(-OutCatenary.Vertex / OutCatenary.CatenaryParam);
+	OutCatenary.StartHeight = OutCatenary.CatenaryParam * cosh(-OutCatenary.Vertex / OutCatenary.CatenaryParam);
+	return true;
+}
+
+FVector FTetherCatenary::GetLocationAtDistance(double Distance) const
+{
+	// Invert the arc length from the start, Distance = CatenaryParam * (sinh((Horizontal - Vertex) / CatenaryParam) - StartSinh)
+	const double Horizontal = Vertex + CatenaryParam * asinh(Distance / CatenaryParam + StartSinh);
+	const double Height = CatenaryParam * cosh((Horizontal - Vertex) / CatenaryParam) - StartHeight;
+	return Start + Horizontal * Across + Height * Up;
+}
@@ -0,0 +1,230 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#include "Simulation/TetherCollisionDistanceField.h"
+#include "Simulation/TetherCollisionSnapshot.h"
+#include "Async/ParallelFor.h"
+
+namespace TetherCollisionDistanceField
+{
+	// Cells along each side of a brick
+	constexpr int32 BrickCells = 8;
+
+	// Samples along each side of a brick, including those shared with the next brick
+	constexpr int32 BrickSamplesPerSide = BrickCells + 1;
+
+	constexpr int32 SamplesPerBrick = BrickSamplesPerSide * BrickSamplesPerSide * BrickSamplesPerSide;
+
+	// Limit on the number of bricks in the grid, beyond which cells are made larger
+	constexpr int64 MaxGridBricks = 1 << 22;
+
+	FORCEINLINE int32 GetSampleIndex(int32 X, int32 Y, int32 Z)
+	{
+		return X + BrickSamplesPerSide * (Y + BrickSamplesPerSide * Z);
+	}
+}
+
+void FTetherCollisionDistanceField::Build(const FTetherCollisionSnapshot& Snapshot, float InCellSize, float InMaxDistance)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherCollisionDistanceField::Build"))
+
+	using namespace TetherCollisionDistanceField;
+
+	bValid = false;
+	RequestedCellSize = InCellSize;
+	MaxDistance = InMaxDistance;
+	BrickIndices.Reset();
+	BrickSamples.Reset();
+	SampleBodies.Reset();
+	NumBricks = 0;
+
+	const FBox& Bounds = Snapshot.GetBounds();
+	if(!Bounds.IsValid || InCellSize <= 0.f)
+	{
+		return;
+	}
+
+	Origin = Bounds.Min;
+	CellSize = InCellSize;
+	const FVector Size = Bounds.GetSize();
+	auto UpdateNumGridBricks = [&]()
+	{
+		const float BrickSize = CellSize * BrickCells;
+		NumGridBricks = FIntVector(
+			FMath::Max(FMath::CeilToInt(Size.X / BrickSize), 1),
+			FMath::Max(FMath::CeilToInt(Size.Y / BrickSize), 1),
+			FMath::Max(FMath::CeilToInt(Size.Z / BrickSize), 1));
+		return (int64)NumGridBricks.X * NumGridBricks.Y * NumGridBricks.Z;
+	};
+	const int64 RequestedGridBricks = UpdateNumGridBricks();
+	if(RequestedGridBricks > MaxGridBricks)
+	{
+		CellSize *= FMath::Pow((float)RequestedGridBricks / MaxGridBricks, 1.f / 3.f) * 1.01f;
+		UpdateNumGridBricks();
+	}
+	const float BrickSize = CellSize * BrickCells;
+
+	// Store bricks that any primitive comes within the maximum distance of, in grid order
+	const int32 NumPrimitives = Snapshot.GetNumPrimitives();
+	TBitArray<> StoredBricks(false, NumGridBricks.X * NumGridBricks.Y * NumGridBricks.Z);
+	for(int32 PrimitiveIdx = 0; PrimitiveIdx < NumPrimitives; PrimitiveIdx++)
+	{
+		const FBox Reach = Snapshot.GetPrimitiveBounds(PrimitiveIdx).ExpandBy(MaxDistance);
+		const FVector Min = (Reach.Min - Origin) / BrickSize;
+		const FVector Max = (Reach.Max - Origin) / BrickSize;
+		const FIntVector First(FMath::Max(FMath::FloorToInt(Min.X), 0), FMath::Max(FMath::FloorToInt(Min.Y), 0), FMath::Max(FMath::FloorToInt(Min.Z), 0));
+		const FIntVector Last(FMath::Min(FMath::FloorToInt(Max.X), NumGridBricks.X - 1), FMath::Min(FMath::FloorToInt(Max.Y), NumGridBricks.Y - 1), FMath::Min(FMath::FloorToInt(Max.Z), NumGridBricks.Z - 1));
+		for(int32 Z = First.Z; Z <= Last.Z; Z++)
+		{
+			for(int32 Y = First.Y; Y <= Last.Y; Y++)
+			{
+				for(int32 X = First.X; X <= Last.X; X++)
+				{
+					StoredBricks[GetGridBrickIndex(X, Y, Z)] = true;
+				}
+			}
+		}
+	}
+
+	TArray<FIntVector> BrickCoords;
+	BrickIndices.Init(INDEX_NONE, StoredBricks.Num());
+	for(int32 Z = 0; Z < NumGridBricks.Z; Z++)
+	{
+		for(int32 Y = 0; Y < NumGridBricks.Y; Y++)
+		{
+			for(int32 X = 0; X < NumGridBricks.X; X++)
+			{
+				const int32 GridBrickIdx = GetGridBrickIndex(X, Y, Z);
+				if(StoredBricks[GridBrickIdx])
+				{
+					BrickIndices[GridBrickIdx] = BrickCoords.Add(FIntVector(X, Y, Z));
+				}
+			}
+		}
+	}
+
+	NumBricks = BrickCoords.Num();
+	BrickSamples.SetNumUninitialized(NumBricks * SamplesPerBrick);
+	SampleBodies.SetNumUninitialized(NumBricks * SamplesPerBrick);
+
+	// Each brick only needs to consider the primitives within reach of it, and bricks don't depend on each other
+	ParallelFor(BrickCoords.Num(), [&](int32 BrickIdx)
+	{
+		const FVector BrickOrigin = Origin + FVector(BrickCoords[BrickIdx]) * BrickSize;
+		const FBox BrickBounds(BrickOrigin, BrickOrigin + FVector(BrickSize));
+
+		TArray<int32> Candidates;
+		Snapshot.GetPrimitivesInBox(BrickBounds.ExpandBy(MaxDistance), Candidates);
+
+		float* Samples = &BrickSamples[BrickIdx * SamplesPerBrick];
+		int32* Bodies = &SampleBodies[BrickIdx * SamplesPerBrick];
+		for(int32 Z = 0; Z < BrickSamplesPerSide; Z++)
+		{
+			for(int32 Y = 0; Y < BrickSamplesPerSide; Y++)
+			{
+				for(int32 X = 0; X < BrickSamplesPerSide; X++)
+				{
+					const FVector Position = BrickOrigin + FVector(FIntVector(X, Y, Z)) * CellSize;
+					float Distance = MaxDistance;
+					int32 NearestBody = INDEX_NONE;
+					for(const int32 PrimitiveIdx : Candidates)
+					{
+						const float PrimitiveDistance = Snapshot.GetPrimitiveDistance(PrimitiveIdx, Position);
+						if(PrimitiveDistance < Distance)
+						{
+							Distance = PrimitiveDistance;
+							NearestBody = Snapshot.GetPrimitiveBodyIndex(PrimitiveIdx);
+						}
+					}
+					Samples[GetSampleIndex(X, Y, Z)] = Distance;
+					Bodies[GetSampleIndex(X, Y, Z)] = NearestBody;
+				}
+			}
+		}
+	});
+
+	bValid = true;
+}
+
+bool FTetherCollisionDistanceField::Sample(const FVector& Position, float& OutDistance, FVector& OutNormal, int32& OutBodyIndex) const
+{
+	using namespace TetherCollisionDistanceField;
+
+	if(!bValid)
+	{
+		return false;
+	}
+
+	const FVector CellPosition = (Position - Origin) / CellSize;
+	const int32 CellX = FMath::FloorToInt(CellPosition.X);
+	const int32 CellY = FMath::FloorToInt(CellPosition.Y);
+	const int32 CellZ = FMath::FloorToInt(CellPosition.Z);
+	if(CellX < 0 || CellY < 0 || CellZ < 0 || CellX >= NumGridBricks.X * BrickCells || CellY >= NumGridBricks.Y * BrickCells || CellZ >= NumGridBricks.Z * BrickCells)
+	{
+		return false;
+	}
+
+	const int32 BrickIdx = BrickIndices[GetGridBrickIndex(CellX / BrickCells, CellY / BrickCells, CellZ / BrickCells)];
+	if(BrickIdx == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Trilinear interpolation of the corners of the cell, and its derivative
+	const float* Samples = &BrickSamples[BrickIdx * SamplesPerBrick];
+	const int32 X = CellX % BrickCells;
+	const int32 Y = CellY % BrickCells;
+	const int32 Z = CellZ % BrickCells;
+	const float FX = CellPosition.X - CellX;
+	const float FY = CellPosition.Y - CellY;
+	const float FZ = CellPosition.Z - CellZ;
+
+	const float D000 = Samples[GetSampleIndex(X, Y, Z)];
+	const float D100 = Samples[GetSampleIndex(X + 1, Y, Z)];
+	const float D010 = Samples[GetSampleIndex(X, Y + 1, Z)];
+	const float D110 = Samples[GetSampleIndex(X + 1, Y + 1, Z)];
+	const float D001 = Samples[GetSampleIndex(X, Y, Z + 1)];
+	const float D101 = Samples[GetSampleIndex(X + 1, Y, Z + 1)];
+	const float D011 = Samples[GetSampleIndex(X, Y + 1, Z + 1)];
+	const float D111 = Samples[GetSampleIndex(X + 1, Y + 1, Z + 1)];
+
+	const float D00 = FMath::Lerp(D000, D100, FX);
+	const float D10 = FMath::Lerp(D010, D110, FX);
+	const float D01 = FMath::Lerp(D001, D101, FX);
+	const float D11 = FMath::Lerp(D011, D111, FX);
+	const float D0 = FMath::Lerp(D00, D10, FY);
+	const float D1 = FMath::Lerp(D01, D11, FY);
+	const float Distance = FMath::Lerp(D0, D1, FZ);
+	if(Distance >= MaxDistance)
+	{
+		return false;
+	}
+
+	const FVector Gradient(
+		FMath::Lerp(FMath::Lerp(D100 - D000, D110 - D010, FY), FMath::Lerp(D101 - D001, D111 - D011, FY), FZ),
+		FMath::Lerp(FMath::Lerp(D010 - D000, D110 - D100, FX), FMath::Lerp(D011 - D001, D111 - D101, FX), FZ),
+		D1 - D0);
+	const FVector Normal = Gradient.GetSafeNormal();
+	if(Normal.IsZero())
+	{
+		return false;
+	}
+
+	// The body of the corner nearest to collision is the one the position is most likely to be touching
+	const int32* Bodies = &SampleBodies[BrickIdx * SamplesPerBrick];
+	int32 NearestCorner = GetSampleIndex(X, Y, Z);
+	float NearestCornerDistance = D000;
+	for(int32 Corner = 1; Corner < 8; Corner++)
+	{
+		const int32 CornerIdx = GetSampleIndex(X + (Corner & 1), Y + ((Corner >> 1) & 1), Z + ((Corner >> 2) & 1));
+		if(Samples[CornerIdx] < NearestCornerDistance)
+		{
+			NearestCornerDistance = Samples[CornerIdx];
+			NearestCorner = CornerIdx;
+		}
+	}
+
+	OutDistance = Distance;
+	OutNormal = Normal;
+	OutBodyIndex = Bodies[NearestCorner];
+	return true;
+}
@@ -0,0 +1,849 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#include "Simulation/TetherCollisionSnapshot.h"
+#include "Simulation/TetherSimulationModel.h"
+#include "Simulation/TetherSimulationParams.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/TriggerBase.h"
+#include "Engine/World.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#include "Misc/EngineVersionComparison.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "WorldCollision.h"
+#if !UE_VERSION_OLDER_THAN(5,2,0)
+#include "Engine/OverlapResult.h"
+#endif
+
+namespace TetherCollisionSnapshot
+{
+	// Primitives per leaf of the hierarchy
+	constexpr int32 MaxLeafPrimitives = 4;
+
+	// Nodes waiting to be visited while sweeping, which is far more than the depth of any hierarchy split at the median
+	constexpr int32 MaxTraversalStack = 64;
+
+	// Earliest time in [0, 1] that a point moving from Start by Delta comes within Radius of the sphere at Center, if it starts outside it
+	bool IntersectSphere(const FVector& Start, const FVector& Delta, const FVector& Center, float Radius, double& OutTime)
+	{
+		const FVector Offset = Start - Center;
+		const double A = Delta | Delta;
+		const double B = Offset | Delta;
+		const double C = (Offset | Offset) - Radius * Radius;
+		const double Discriminant = B * B - A * C;
+		if(A <= SMALL_NUMBER || B >= 0. || Discriminant < 0.)
+		{
+			return false;
+		}
+		const double Time = (-B - FMath::Sqrt(Discriminant)) / A;
+		if(Time < 0. || Time > 1.)
+		{
+			return false;
+		}
+		OutTime = Time;
+		return true;
+	}
+
+	// Earliest time in [0, 1] that a point moving from Start by Delta comes within Radius of the segment from SegmentStart to SegmentEnd, if it starts outside the capsule
+	bool IntersectCapsule(const FVector& Start, const FVector& Delta, const FVector& SegmentStart, const FVector& SegmentEnd, float Radius, double& OutTime)
+	{
+		bool bHit = false;
+		double BestTime = 2.;
+
+		// Cylinder between the ends, ignoring movement along the axis
+		const FVector Axis = SegmentEnd - SegmentStart;
+		const double AxisLengthSquared = Axis | Axis;
+		if(AxisLengthSquared > SMALL_NUMBER)
+		{
+			const FVector Offset = Start - SegmentStart;
+			const double OffsetAlongAxis = Offset | Axis;
+			const double DeltaAlongAxis = Delta | Axis;
+			const FVector OffsetPerpendicular = Offset - Axis * (OffsetAlongAxis / AxisLengthSquared);
+			const FVector DeltaPerpendicular = Delta - Axis * (DeltaAlongAxis / AxisLengthSquared);
+			const double A = DeltaPerpendicular | DeltaPerpendicular;
+			const double B = OffsetPerpendicular | DeltaPerpendicular;
+			const double C = (OffsetPerpendicular | OffsetPerpendicular) - Radius * Radius;
+			const double Discriminant = B * B - A * C;
+			if(A > SMALL_NUMBER && B < 0. && Discriminant >= 0.)
+			{
+				const double Time = (-B - FMath::Sqrt(Discriminant)) / A;
+				const double AxisFraction = (OffsetAlongAxis + Time * DeltaAlongAxis) / AxisLengthSquared;
+				if(Time >= 0. && Time <= 1. && AxisFraction >= 0. && AxisFraction <= 1.)
+				{
+					BestTime = Time;
+					bHit = true;
+				}
+			}
+		}
+
+		// Spheres at each end
+		double Time;
+		if(IntersectSphere(Start, Delta, SegmentStart, Radius, Time) && Time < BestTime)
+		{
+			BestTime = Time;
+			bHit = true;
+		}
+		if(IntersectSphere(Start, Delta, SegmentEnd, Radius, Time) && Time < BestTime)
+		{
+			BestTime = Time;
+			bHit = true;
+		}
+
+		if(bHit)
+		{
+			OutTime = BestTime;
+		}
+		return bHit;
+	}
+
+	// Transform of the body of a component that an overlap was found with, which is the instance for instanced static meshes
+	FTransform GetBodyTransform(const UPrimitiveComponent* Component, int32 Item)
+	{
+		const UInstancedStaticMeshComponent* InstancedComponent = Cast<UInstancedStaticMeshComponent>(Component);
+		FTransform Transform;
+		if(InstancedComponent && Item != INDEX_NONE && InstancedComponent->GetInstanceTransform(Item, Transform, true))
+		{
+			return Transform;
+		}
+		return Component->GetComponentTransform();
+	}
+
+	bool BoundsEqual(const FBoxSphereBounds& A, const FBoxSphereBounds& B)
+	{
+		return A.Origin == B.Origin && A.BoxExtent == B.BoxExtent && A.SphereRadius == B.SphereRadius;
+	}
+
+	// Finds everything that could be hit within the bounds, in a consistent order
+	void GatherOverlaps(const FTetherSimulationParams& Params, const FBox& Bounds, TArray<FOverlapResult>& OutOverlaps)
+	{
+		OutOverlaps.Reset();
+		if(!Params.World.IsValid(false, true) || !Bounds.IsValid)
+		{
+			return;
+		}
+		UWorld* World = Params.World.Get();
+
+		ECollisionChannel TraceChannel = ECC_PhysicsBody;
+		FCollisionResponseParams ResponseParams = FCollisionResponseParams();
+		UCollisionProfile::GetChannelAndResponseParams(Params.SimulationOptions.CollisionProfile.Name, TraceChannel, ResponseParams);
+		World->OverlapMultiByChannel(OutOverlaps, Bounds.GetCenter(), FQuat::Identity, TraceChannel, FCollisionShape::MakeBox(Bounds.GetExtent()), Params.CollisionQueryParams, ResponseParams);
+
+		// Triggers are never collided with, and the simulated component moves while simulating so can't be copied
+		const UPrimitiveComponent* OwnComponent = Params.Component.IsValid(false, true) ? Params.Component.Get() : nullptr;
+		OutOverlaps.RemoveAll([OwnComponent](const FOverlapResult& Overlap)
+		{
+			const UPrimitiveComponent* Component = Overlap.GetComponent();
+			const AActor* Actor = Overlap.GetActor();
+			return !IsValid(Component) || Component == OwnComponent || (IsValid(Actor) && Actor->IsA<ATriggerBase>());
+		});
+
+		Algo::Sort(OutOverlaps, [](const FOverlapResult& A, const FOverlapResult& B)
+		{
+			const uint32 IdA = A.GetComponent()->GetUniqueID();
+			const uint32 IdB = B.GetComponent()->GetUniqueID();
+			return IdA < IdB || (IdA == IdB && A.ItemIndex < B.ItemIndex);
+		});
+		OutOverlaps.SetNum(Algo::Unique(OutOverlaps, [](const FOverlapResult& A, const FOverlapResult& B)
+		{
+			return A.GetComponent() == B.GetComponent() && A.ItemIndex == B.ItemIndex;
+		}));
+	}
+}
+
+FBox FTetherCollisionSnapshot::GetSimulationBounds(const FTetherSimulationModel& Model, const FTetherSimulationParams& Params)
+{
+	FBox Result(ForceInit);
+	for(const FTetherSimulationSegment& Segment : Model.Segments)
+	{
+		if(Segment.GetNumParticles() < 1)
+		{
+			continue;
+		}
+
+		FBox ParticleBounds(ForceInit);
+		for(const FTetherSimulationParticle& Particle : Segment.Particles)
+		{
+			ParticleBounds += Particle.Position;
+		}
+
+		// Every particle is within the length of the segment of any particle of it
+		FBox SegmentBounds = ParticleBounds.ExpandBy(Segment.Length);
+
+		// Which is much less room than that when both ends are fixed, as no particle can be further than the length from either end
+		const FTetherSimulationParticle& First = Segment.Particles[0];
+		const FTetherSimulationParticle& Last = Segment.Particles.Last();
+		if(!First.bFree && !Last.bFree)
+		{
+			const FBox StartReach = FBox(First.Position, First.Position).ExpandBy(Segment.Length);
+			const FBox EndReach = FBox(Last.Position, Last.Position).ExpandBy(Segment.Length);
+			SegmentBounds = StartReach.Overlap(EndReach) + ParticleBounds;
+		}
+
+		Result += SegmentBounds.ExpandBy(Params.CollisionWidth);
+	}
+	return Result;
+}
+
+uint32 FTetherCollisionSnapshot::GetQueryHash(const FTetherSimulationParams& Params)
+{
+	uint32 Hash = GetTypeHash(Params.SimulationOptions.CollisionProfile.Name);
+	Hash = HashCombine(Hash, GetTypeHash(Params.CollisionQueryParams.bTraceComplex));
+	Hash = HashCombine(Hash, GetTypeHash(Params.Component.Get()));
+	for(const uint32 Actor : Params.CollisionQueryParams.GetIgnoredActors())
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Actor));
+	}
+	for(const uint32 Component : Params.CollisionQueryParams.GetIgnoredComponents())
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Component));
+	}
+	return Hash;
+}
+
+void FTetherCollisionSnapshot::Build(const FTetherSimulationParams& Params, const FBox& InBounds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherCollisionSnapshot::Build"))
+
+	check(IsInGameThread());
+
+	bValid = false;
+	Bounds = InBounds;
+	QueryHash = GetQueryHash(Params);
+	Bodies.Reset();
+	Primitives.Reset();
+	Nodes.Reset();
+	SweptComponentBodies.Reset();
+	DistanceField = FTetherCollisionDistanceField();
+
+	FCollisionResponseParams ResponseParams = FCollisionResponseParams();
+	UCollisionProfile::GetChannelAndResponseParams(Params.SimulationOptions.CollisionProfile.Name, TraceChannel, ResponseParams);
+	bTraceComplex = Params.CollisionQueryParams.bTraceComplex;
+
+	if(!Params.World.IsValid(false, true) || !Bounds.IsValid)
+	{
+		return;
+	}
+
+	TArray<FOverlapResult> Overlaps;
+	TetherCollisionSnapshot::GatherOverlaps(Params, Bounds, Overlaps);
+
+	for(const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+
+		const int32 BodyIndex = Bodies.AddDefaulted();
+		FBody& Body = Bodies[BodyIndex];
+		Body.Component = Component;
+		Body.Actor = Overlap.GetActor();
+		Body.Item = Overlap.ItemIndex;
+		Body.BodySetup = Component->GetBodySetup();
+		Body.Transform = TetherCollisionSnapshot::GetBodyTransform(Component, Overlap.ItemIndex);
+		Body.ComponentBounds = Component->Bounds;
+
+		const int32 NumPrimitives = Primitives.Num();
+		if(!AddBodyCollision(Body, BodyIndex))
+		{
+			// Sweep the whole component rather than a partial copy of it
+			Primitives.SetNum(NumPrimitives);
+			Body.bSweepComponent = true;
+			SweptComponentBodies.Add(BodyIndex);
+		}
+	}
+
+	BuildHierarchy();
+}
+
+bool FTetherCollisionSnapshot::AddBodyCollision(const FBody& Body, int32 BodyIndex)
+{
+	const UBodySetup* BodySetup = Body.BodySetup.Get();
+	if(!BodySetup)
+	{
+		return false;
+	}
+
+	const FTransform& Transform = Body.Transform;
+	const ECollisionTraceFlag TraceFlag = BodySetup->GetCollisionTraceFlag();
+	const bool bUseComplex = bTraceComplex ? TraceFlag != CTF_UseSimpleAsComplex : TraceFlag == CTF_UseComplexAsSimple;
+
+	auto AddWorldTriangle = [&](const FVector& A, const FVector& B, const FVector& C, int32 FaceIndex)
+	{
+		// Only keep triangles that could be reached from within the snapshot
+		FBox TriangleBounds(A, A);
+		TriangleBounds += B;
+		TriangleBounds += C;
+		if(TriangleBounds.Intersect(Bounds))
+		{
+			AddTriangle(A, B, C, BodyIndex, FaceIndex);
+		}
+	};
+
+	if(bUseComplex)
+	{
+		IInterface_CollisionDataProvider* CollisionDataProvider = Cast<IInterface_CollisionDataProvider>(BodySetup->GetOuter());
+		FTriMeshCollisionData TriMeshData;
+		if(!CollisionDataProvider || !CollisionDataProvider->ContainsPhysicsTriMeshData(BodySetup->bMeshCollideAll) || !CollisionDataProvider->GetPhysicsTriMeshData(&TriMeshData, BodySetup->bMeshCollideAll))
+		{
+			return false;
+		}
+
+		TArray<FVector> WorldVertices;
+		WorldVertices.SetNumUninitialized(TriMeshData.Vertices.Num());
+		for(int32 i = 0; i < TriMeshData.Vertices.Num(); i++)
+		{
+			WorldVertices[i] = Transform.TransformPosition(FVector(TriMeshData.Vertices[i]));
+		}
+		for(int32 FaceIndex = 0; FaceIndex < TriMeshData.Indices.Num(); FaceIndex++)
+		{
+			const FTriIndices& Indices = TriMeshData.Indices[FaceIndex];
+			AddWorldTriangle(WorldVertices[Indices.v0], WorldVertices[Indices.v1], WorldVertices[Indices.v2], FaceIndex);
+		}
+		return true;
+	}
+
+	const FKAggregateGeom& AggGeom = BodySetup->AggGeom;
+	if(AggGeom.TaperedCapsuleElems.Num() > 0)
+	{
+		return false;
+	}
+
+	const FVector AbsScale = Transform.GetScale3D().GetAbs();
+	for(const FKSphereElem& Sphere : AggGeom.SphereElems)
+	{
+		const FVector Center = Transform.TransformPosition(Sphere.Center);
+		AddCapsule(Center, Center, Sphere.Radius * AbsScale.GetMin(), BodyIndex);
+	}
+
+	for(const FKSphylElem& Sphyl : AggGeom.SphylElems)
+	{
+		const FVector HalfAxis = FQuat(Sphyl.Rotation).RotateVector(FVector(0.f, 0.f, 0.5f * Sphyl.Length));
+		const float Radius = Sphyl.Radius * FMath::Max(AbsScale.X, AbsScale.Y);
+		AddCapsule(Transform.TransformPosition(Sphyl.Center - HalfAxis), Transform.TransformPosition(Sphyl.Center + HalfAxis), Radius, BodyIndex);
+	}
+
+	for(const FKBoxElem& Box : AggGeom.BoxElems)
+	{
+		const FQuat Rotation(Box.Rotation);
+		FVector Corners[8];
+		for(int32 i = 0; i < 8; i++)
+		{
+			const FVector Offset(i & 1 ? 0.5f * Box.X : -0.5f * Box.X, i & 2 ? 0.5f * Box.Y : -0.5f * Box.Y, i & 4 ? 0.5f * Box.Z : -0.5f * Box.Z);
+			Corners[i] = Transform.TransformPosition(Box.Center + Rotation.RotateVector(Offset));
+		}
+
+		// Two triangles for each face of the box
+		static const int32 FaceCorners[6][4] = { { 0, 1, 3, 2 }, { 4, 6, 7, 5 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 5, 7, 3 } };
+		for(const int32 (&Face)[4] : FaceCorners)
+		{
+			AddWorldTriangle(Corners[Face[0]], Corners[Face[1]], Corners[Face[2]], INDEX_NONE);
+			AddWorldTriangle(Corners[Face[0]], Corners[Face[2]], Corners[Face[3]], INDEX_NONE);
+		}
+	}
+
+	for(const FKConvexElem& Convex : AggGeom.ConvexElems)
+	{
+		if(Convex.IndexData.Num() < 3)
+		{
+			return false;
+		}
+
+		const FTransform ConvexTransform = Convex.GetTransform() * Transform;
+		TArray<FVector> WorldVertices;
+		WorldVertices.SetNumUninitialized(Convex.VertexData.Num());
+		for(int32 i = 0; i < Convex.VertexData.Num(); i++)
+		{
+			WorldVertices[i] = ConvexTransform.TransformPosition(Convex.VertexData[i]);
+		}
+		for(int32 i = 0; i + 2 < Convex.IndexData.Num(); i += 3)
+		{
+			AddWorldTriangle(WorldVertices[Convex.IndexData[i]], WorldVertices[Convex.IndexData[i + 1]], WorldVertices[Convex.IndexData[i + 2]], INDEX_NONE);
+		}
+	}
+
+	return true;
+}
+
+bool FTetherCollisionSnapshot::IsUpToDate(const FTetherSimulationParams& Params, const FBox& RequiredBounds) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherCollisionSnapshot::IsUpToDate"))
+
+	check(IsInGameThread());
+
+	if(!bValid || QueryHash != GetQueryHash(Params) || !RequiredBounds.IsValid || !Bounds.IsInside(RequiredBounds))
+	{
+		return false;
+	}
+
+	// Anything added to or removed from the bounds changes what overlaps them
+	TArray<FOverlapResult> Overlaps;
+	TetherCollisionSnapshot::GatherOverlaps(Params, Bounds, Overlaps);
+	if(Overlaps.Num() != Bodies.Num())
+	{
+		return false;
+	}
+
+	for(int32 i = 0; i < Bodies.Num(); i++)
+	{
+		const FBody& Body = Bodies[i];
+		const UPrimitiveComponent* Component = Overlaps[i].GetComponent();
+		if(Component != Body.Component.Get() || Overlaps[i].ItemIndex != Body.Item)
+		{
+			return false;
+		}
+
+		// Moved, or had its collision replaced or rebuilt
+		if(Component->GetBodySetup() != Body.BodySetup.Get()
+			|| !TetherCollisionSnapshot::GetBodyTransform(Component, Body.Item).Equals(Body.Transform, 0.f)
+			|| !TetherCollisionSnapshot::BoundsEqual(Component->Bounds, Body.ComponentBounds))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FTetherCollisionSnapshot::Contains(const FVector& Start, const FVector& End, float Radius) const
+{
+	FBox SweepBounds(Start, Start);
+	SweepBounds += End;
+	return bValid && Bounds.IsInside(SweepBounds.ExpandBy(Radius));
+}
+
+void FTetherCollisionSnapshot::AddTriangle(const FVector& A, const FVector& B, const FVector& C, int32 BodyIndex, int32 FaceIndex)
+{
+	FPrimitive& Primitive = Primitives.AddDefaulted_GetRef();
+	Primitive.A = A;
+	Primitive.B = B;
+	Primitive.C = C;
+	Primitive.BodyIndex = BodyIndex;
+	Primitive.FaceIndex = FaceIndex;
+	Primitive.bTriangle = true;
+}
+
+void FTetherCollisionSnapshot::AddCapsule(const FVector& A, const FVector& B, float Radius, int32 BodyIndex)
+{
+	FPrimitive& Primitive = Primitives.AddDefaulted_GetRef();
+	Primitive.A = A;
+	Primitive.B = B;
+	Primitive.C = B;
+	Primitive.Radius = Radius;
+	Primitive.BodyIndex = BodyIndex;
+	Primitive.bTriangle = false;
+}
+
+FBox FTetherCollisionSnapshot::FPrimitive::GetBounds() const
+{
+	FBox Result(A, A);
+	Result += B;
+	Result += C;
+	return Result.ExpandBy(Radius);
+}
+
+void FTetherCollisionSnapshot::BuildHierarchy()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherCollisionSnapshot::BuildHierarchy"))
+
+	Nodes.Reset();
+	if(!Bounds.IsValid)
+	{
+		// Snapshots built by hand cover their own primitives
+		for(const FPrimitive& Primitive : Primitives)
+		{
+			Bounds += Primitive.GetBounds();
+		}
+	}
+	if(Primitives.Num() > 0)
+	{
+		Nodes.Reserve(2 * Primitives.Num() / TetherCollisionSnapshot::MaxLeafPrimitives + 1);
+		BuildNode(0, Primitives.Num());
+	}
+	bValid = true;
+}
+
+int32 FTetherCollisionSnapshot::BuildNode(int32 Begin, int32 End)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+
+	FBox NodeBounds(ForceInit);
+	FBox CentreBounds(ForceInit);
+	for(int32 i = Begin; i < End; i++)
+	{
+		const FBox PrimitiveBounds = Primitives[i].GetBounds();
+		NodeBounds += PrimitiveBounds;
+		CentreBounds += PrimitiveBounds.GetCenter();
+	}
+	Nodes[NodeIndex].Bounds = NodeBounds;
+
+	if(End - Begin <= TetherCollisionSnapshot::MaxLeafPrimitives)
+	{
+		Nodes[NodeIndex].FirstIndex = Begin;
+		Nodes[NodeIndex].NumPrimitives = End - Begin;
+		return NodeIndex;
+	}
+
+	// Split at the median along the longest axis of the primitive centres
+	const FVector CentreExtent = CentreBounds.GetExtent();
+	const int32 Axis = CentreExtent.X >= CentreExtent.Y && CentreExtent.X >= CentreExtent.Z ? 0 : (CentreExtent.Y >= CentreExtent.Z ? 1 : 2);
+	const int32 Middle = Begin + (End - Begin) / 2;
+	Algo::Sort(MakeArrayView(&Primitives[Begin], End - Begin), [Axis](const FPrimitive& A, const FPrimitive& B)
+	{
+		return A.GetBounds().GetCenter()[Axis] < B.GetBounds().GetCenter()[Axis];
+	});
+
+	// Children are always next to each other, so only the first needs to be stored
+	const int32 FirstChild = BuildNode(Begin, Middle);
+	BuildNode(Middle, End);
+	check(FirstChild == NodeIndex + 1);
+	Nodes[NodeIndex].FirstIndex = FirstChild;
+	Nodes[NodeIndex].NumPrimitives = 0;
+	return NodeIndex;
+}
+
+void FTetherCollisionSnapshot::BuildDistanceField(float CellSize, float MaxDistance)
+{
+	DistanceField.Build(*this, CellSize, MaxDistance);
+}
+
+void FTetherCollisionSnapshot::GetPrimitivesInBox(const FBox& Box, TArray<int32>& OutPrimitives) const
+{
+	if(Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	int32 Stack[TetherCollisionSnapshot::MaxTraversalStack];
+	int32 StackSize = 0;
+	Stack[StackSize++] = 0;
+	while(StackSize > 0)
+	{
+		const FNode& Node = Nodes[Stack[--StackSize]];
+		if(!Node.Bounds.Intersect(Box))
+		{
+			continue;
+		}
+
+		if(Node.NumPrimitives == 0)
+		{
+			check(StackSize + 2 <= TetherCollisionSnapshot::MaxTraversalStack);
+			Stack[StackSize++] = Node.FirstIndex + 1;
+			Stack[StackSize++] = Node.FirstIndex;
+			continue;
+		}
+
+		for(int32 i = Node.FirstIndex; i < Node.FirstIndex + Node.NumPrimitives; i++)
+		{
+			if(Primitives[i].GetBounds().Intersect(Box))
+			{
+				OutPrimitives.Add(i);
+			}
+		}
+	}
+}
+
+float FTetherCollisionSnapshot::GetDistanceToNearest(const FVector& Point, float MaxDistance) const
+{
+	float Nearest = MaxDistance;
+	if(Nodes.Num() > 0)
+	{
+		int32 Stack[TetherCollisionSnapshot::MaxTraversalStack];
+		int32 StackSize = 0;
+		Stack[StackSize++] = 0;
+		while(StackSize > 0)
+		{
+			const FNode& Node = Nodes[Stack[--StackSize]];
+			if(Node.Bounds.ComputeSquaredDistanceToPoint(Point) >= FMath::Square(Nearest))
+			{
+				continue;
+			}
+
+			if(Node.NumPrimitives == 0)
+			{
+				check(StackSize + 2 <= TetherCollisionSnapshot::MaxTraversalStack);
+				Stack[StackSize++] = Node.FirstIndex + 1;
+				Stack[StackSize++] = Node.FirstIndex;
+				continue;
+			}
+
+			for(int32 i = Node.FirstIndex; i < Node.FirstIndex + Node.NumPrimitives; i++)
+			{
+				Nearest = FMath::Min(Nearest, GetPrimitiveDistance(i, Point));
+			}
+		}
+	}
+
+	for(const int32 BodyIndex : SweptComponentBodies)
+	{
+		Nearest = FMath::Min(Nearest, FMath::Sqrt(Bodies[BodyIndex].ComponentBounds.GetBox().ComputeSquaredDistanceToPoint(Point)));
+	}
+
+	return FMath::Max(Nearest, 0.f);
+}
+
+float FTetherCollisionSnapshot::GetPrimitiveDistance(int32 PrimitiveIndex, const FVector& Point) const
+{
+	const FPrimitive& Primitive = Primitives[PrimitiveIndex];
+	if(Primitive.bTriangle)
+	{
+		return FVector::Dist(Point, FMath::ClosestPointOnTriangleToPoint(Point, Primitive.A, Primitive.B, Primitive.C));
+	}
+	return FVector::Dist(Point, FMath::ClosestPointOnSegment(Point, Primitive.A, Primitive.B)) - Primitive.Radius;
+}
+
+bool FTetherCollisionSnapshot::SweepPrimitive(const FPrimitive& Primitive, const FVector& Start, const FVector& Delta, float Radius, FHitResult& OutHit) const
+{
+	if(Primitive.bTriangle)
+	{
+		const FVector& A = Primitive.A;
+		const FVector& B = Primitive.B;
+		const FVector& C = Primitive.C;
+		FVector FaceNormal = ((B - A) ^ (C - A)).GetSafeNormal();
+
+		// Triangles are two sided, so face whichever side the sweep starts on
+		const double StartDistance = (Start - A) | FaceNormal;
+		if(StartDistance < 0.)
+		{
+			FaceNormal = -FaceNormal;
+		}
+
+		const FVector StartClosest = FMath::ClosestPointOnTriangleToPoint(Start, A, B, C);
+		const FVector StartOffset = Start - StartClosest;
+		const float StartOffsetSize = StartOffset.Size();
+		if(StartOffsetSize < Radius)
+		{
+			OutHit.bStartPenetrating = true;
+			OutHit.Time = 0.f;
+			OutHit.Normal = StartOffsetSize > KINDA_SMALL_NUMBER ? StartOffset / StartOffsetSize : (FaceNormal.IsZero() ? -Delta.GetSafeNormal() : FaceNormal);
+			OutHit.ImpactNormal = FaceNormal.IsZero() ? OutHit.Normal : FaceNormal;
+			OutHit.PenetrationDepth = Radius - StartOffsetSize;
+			OutHit.Location = Start;
+			OutHit.ImpactPoint = StartClosest;
+			OutHit.FaceIndex = Primitive.FaceIndex;
+			return true;
+		}
+
+		// The face is always touched first if the point of contact is within the triangle
+		const double DeltaAlongNormal = Delta | FaceNormal;
+		if(!FaceNormal.IsZero() && DeltaAlongNormal < -SMALL_NUMBER)
+		{
+			const double Time = (FMath::Abs(StartDistance) - Radius) / -DeltaAlongNormal;
+			if(Time >= 0. && Time <= 1.)
+			{
+				const FVector Contact = Start + Time * Delta - FaceNormal * Radius;
+				const FVector Barycentric = FMath::ComputeBaryCentric2D(Contact, A, B, C);
+				if(Barycentric.X >= 0.f && Barycentric.Y >= 0.f && Barycentric.Z >= 0.f)
+				{
+					OutHit.bStartPenetrating = false;
+					OutHit.Time = Time;
+					OutHit.Normal = FaceNormal;
+					OutHit.ImpactNormal = FaceNormal;
+					OutHit.PenetrationDepth = 0.f;
+					OutHit.Location = Start + Time * Delta;
+					OutHit.ImpactPoint = Contact;
+					OutHit.FaceIndex = Primitive.FaceIndex;
+					return true;
+				}
+			}
+		}
+
+		// Otherwise the first touch is on an edge or corner
+		bool bHit = false;
+		double BestTime = 2.;
+		const FVector* Edges[3][2] = { { &A, &B }, { &B, &C }, { &C, &A } };
+		for(const FVector* (&Edge)[2] : Edges)
+		{
+			double Time;
+			if(TetherCollisionSnapshot::IntersectCapsule(Start, Delta, *Edge[0], *Edge[1], Radius, Time) && Time < BestTime)
+			{
+				BestTime = Time;
+				bHit = true;
+			}
+		}
+		if(!bHit)
+		{
+			return false;
+		}
+
+		const FVector Location = Start + BestTime * Delta;
+		const FVector Contact = FMath::ClosestPointOnTriangleToPoint(Location, A, B, C);
+		OutHit.bStartPenetrating = false;
+		OutHit.Time = BestTime;
+		OutHit.Normal = (Location - Contact).GetSafeNormal();
+		OutHit.ImpactNormal = FaceNormal.IsZero() ? OutHit.Normal : FaceNormal;
+		OutHit.PenetrationDepth = 0.f;
+		OutHit.Location = Location;
+		OutHit.ImpactPoint = Contact;
+		OutHit.FaceIndex = Primitive.FaceIndex;
+		return true;
+	}
+
+	// Sweeping a sphere against a capsule is the same as sweeping a point against a capsule with both radii
+	const float CombinedRadius = Primitive.Radius + Radius;
+	const FVector StartClosest = FMath::ClosestPointOnSegment(Start, Primitive.A, Primitive.B);
+	const FVector StartOffset = Start - StartClosest;
+	const float StartOffsetSize = StartOffset.Size();
+	if(StartOffsetSize < CombinedRadius)
+	{
+		const FVector Normal = StartOffsetSize > KINDA_SMALL_NUMBER ? StartOffset / StartOffsetSize : -Delta.GetSafeNormal();
+		OutHit.bStartPenetrating = true;
+		OutHit.Time = 0.f;
+		OutHit.Normal = Normal;
+		OutHit.ImpactNormal = Normal;
+		OutHit.PenetrationDepth = CombinedRadius - StartOffsetSize;
+		OutHit.Location = Start;
+		OutHit.ImpactPoint = StartClosest + Normal * Primitive.Radius;
+		OutHit.FaceIndex = INDEX_NONE;
+		return true;
+	}
+
+	double Time;
+	if(!TetherCollisionSnapshot::IntersectCapsule(Start, Delta, Primitive.A, Primitive.B, CombinedRadius, Time))
+	{
+		return false;
+	}
+
+	const FVector Location = Start + Time * Delta;
+	const FVector Normal = (Location - FMath::ClosestPointOnSegment(Location, Primitive.A, Primitive.B)).GetSafeNormal();
+	OutHit.bStartPenetrating = false;
+	OutHit.Time = Time;
+	OutHit.Normal = Normal;
+	OutHit.ImpactNormal = Normal;
+	OutHit.PenetrationDepth = 0.f;
+	OutHit.Location = Location;
+	OutHit.ImpactPoint = Location - Normal * Radius;
+	OutHit.FaceIndex = INDEX_NONE;
+	return true;
+}
+
+void FTetherCollisionSnapshot::FillHit(FHitResult& Hit, int32 BodyIndex, const FVector& Start, const FVector& End) const
+{
+	Hit.bBlockingHit = true;
+	Hit.TraceStart = Start;
+	Hit.TraceEnd = End;
+	Hit.Distance = Hit.Time * FVector::Dist(Start, End);
+	if(Bodies.IsValidIndex(BodyIndex))
+	{
+		const FBody& Body = Bodies[BodyIndex];
+		Hit.Component = Body.Component;
+		Hit.Item = Body.Item;
+#if UE_VERSION_OLDER_THAN(5,0,0)
+		Hit.Actor = Body.Actor;
+#else
+		Hit.HitObjectHandle = FActorInstanceHandle(Body.Actor.Get());
+#endif
+	}
+}
+
+bool FTetherCollisionSnapshot::SweepSphere(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius) const
+{
+	if(!bValid)
+	{
+		return false;
+	}
+
+	const FVector Delta = End - Start;
+	FBox SweepBounds(Start, Start);
+	SweepBounds += End;
+	SweepBounds = SweepBounds.ExpandBy(Radius);
+
+	// Keep only the first hit with each body, or the deepest if it starts penetrating
+	const int32 FirstHitIdx = OutHits.Num();
+	TArray<int32, TInlineAllocator<8>> HitBodies;
+	auto AddHit = [&](const FHitResult& Hit, int32 BodyIndex)
+	{
+		const int32 ExistingIdx = HitBodies.Find(BodyIndex);
+		if(ExistingIdx == INDEX_NONE)
+		{
+			HitBodies.Add(BodyIndex);
+			OutHits.Add(Hit);
+			return;
+		}
+
+		FHitResult& Existing = OutHits[FirstHitIdx + ExistingIdx];
+		const bool bDeeper = Hit.bStartPenetrating && (!Existing.bStartPenetrating || Hit.PenetrationDepth > Existing.PenetrationDepth);
+		const bool bEarlier = !Hit.bStartPenetrating && !Existing.bStartPenetrating && Hit.Time < Existing.Time;
+		if(bDeeper || bEarlier)
+		{
+			Existing = Hit;
+		}
+	};
+
+	if(Nodes.Num() > 0)
+	{
+		int32 Stack[TetherCollisionSnapshot::MaxTraversalStack];
+		int32 StackSize = 0;
+		Stack[StackSize++] = 0;
+		while(StackSize > 0)
+		{
+			const FNode& Node = Nodes[Stack[--StackSize]];
+			if(!Node.Bounds.Intersect(SweepBounds))
+			{
+				continue;
+			}
+
+			if(Node.NumPrimitives == 0)
+			{
+				check(StackSize + 2 <= TetherCollisionSnapshot::MaxTraversalStack);
+				Stack[StackSize++] = Node.FirstIndex + 1;
+				Stack[StackSize++] = Node.FirstIndex;
+				continue;
+			}
+
+			for(int32 i = Node.FirstIndex; i < Node.FirstIndex + Node.NumPrimitives; i++)
+			{
+				const FPrimitive& Primitive = Primitives[i];
+				FHitResult Hit;
+				if(SweepPrimitive(Primitive, Start, Delta, Radius, Hit))
+				{
+					AddHit(Hit, Primitive.BodyIndex);
+				}
+			}
+		}
+	}
+
+	for(int32 i = 0; i < HitBodies.Num(); i++)
+	{
+		FillHit(OutHits[FirstHitIdx + i], HitBodies[i], Start, End);
+	}
+
+	// Primitives that couldn't be copied are swept individually
+	SweepComponents(OutHits, Start, End, Radius, SweepBounds);
+
+	return OutHits.Num() > FirstHitIdx;
+}
+
+bool FTetherCollisionSnapshot::SweepSweptComponents(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius) const
+{
+	if(!bValid)
+	{
+		return false;
+	}
+
+	FBox SweepBounds(Start, Start);
+	SweepBounds += End;
+	SweepBounds = SweepBounds.ExpandBy(Radius);
+
+	const int32 FirstHitIdx = OutHits.Num();
+	SweepComponents(OutHits, Start, End, Radius, SweepBounds);
+	return OutHits.Num() > FirstHitIdx;
+}
+
+void FTetherCollisionSnapshot::SweepComponents(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius, const FBox& SweepBounds) const
+{
+	for(const int32 BodyIndex : SweptComponentBodies)
+	{
+		const FBody& Body = Bodies[BodyIndex];
+		if(!Body.ComponentBounds.GetBox().Intersect(SweepBounds) || !Body.Component.IsValid(false, true))
+		{
+			continue;
+		}
+
+		FHitResult Hit;
+		if(Body.Component.Get()->SweepComponent(Hit, Start, End, FQuat::Identity, FCollisionShape::MakeSphere(Radius), bTraceComplex))
+		{
+			FillHit(Hit, BodyIndex, Start, End);
+			OutHits.Add(Hit);
+		}
+	}
+}
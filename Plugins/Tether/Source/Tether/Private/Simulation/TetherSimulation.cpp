@@ -8,10 +8,19 @@
 #include "Engine/World.h"
 #include "Physics/PhysicsInterfaceCore.h"
 #include "Simulation/TetherPhysicsUtils.h"
+#include "Simulation/TetherCatenary.h"
+#include "Simulation/TetherCollisionSnapshot.h"
+#include "Simulation/TetherSimulationConstraintProgram.h"
 #include "Simulation/TetherSimulationContext.h"
 #include "TaskTypes.h"
+#include "Templates/IntegerSequence.h"
 #include "Engine/TriggerBase.h"
+#include "Async/ParallelFor.h"
 #include "Misc/EngineVersionComparison.h"
+#include "WorldCollision.h"
+#if !UE_VERSION_OLDER_THAN(5,2,0)
+#include "Engine/OverlapResult.h"
+#endif
 
 DEFINE_LOG_CATEGORY(LogTetherSimulation);
 
@@ -19,6 +28,9 @@ DEFINE_LOG_CATEGORY(LogTetherSimulation);
 #define TETHER_SIMULATION_DEBUG_CHECKS 1
 #endif
 
+// Most cables only touch a few components, and the list of hit components grows if a cable touches more
+static constexpr int32 ReservedHitComponents = 16;
+
 static TAutoConsoleVariable<int32> CVarDebugSubstep(
 	TEXT("Tether.DebugSubstep"),
 	-1,
@@ -31,25 +43,393 @@ static TAutoConsoleVariable<int32> CVarDebugParticle(
     TEXT("Defines a particle unique ID in the simulation for which to dump extremely verbose debugging information."),
     ECVF_RenderThreadSafe);
 
+static TAutoConsoleVariable<int32> CVarVectorizedIntegration(
+	TEXT("Tether.VectorizedIntegration"),
+	1,
+	TEXT("If enabled, particles are integrated several at a time using vector registers. Otherwise, particles are integrated one at a time."),
+	ECVF_RenderThreadSafe);
+
 static TAutoConsoleVariable<int32> CVarTruncateHits(
 	TEXT("Tether.TruncateHits"),
 	1,
 	TEXT(""),
 	ECVF_RenderThreadSafe);
 
+static TAutoConsoleVariable<int32> CVarSubstepDebug(
+	TEXT("Tether.SubstepDebug"),
+	0,
+	TEXT("If enabled, substeps are always simulated with debugging compiled in. Otherwise, debugging is only compiled in when requested by Tether.DebugSubstep, Tether.DebugParticle or very verbose simulation logging."),
+	ECVF_RenderThreadSafe);
+
+template<uint32... FeatureCombinations>
+struct FTetherSimulation::TSubstepTable<TIntegerSequence<uint32, FeatureCombinations...>>
+{
+	typedef void (*FSubstepFunction)(FTetherSimulationContext&, TArrayView<FTetherProxySimulationSegmentSeries>, float, int32);
+	typedef void (*FBatchSubstepFunction)(TArrayView<FBatchSeriesSubstep>, float);
+
+	static FSubstepFunction Get(uint32 Features)
+	{
+		static const FSubstepFunction Functions[] = { &FTetherSimulation::PerformSimulationSubstep<FeatureCombinations>... };
+		check(Features < SubstepFeature_NumCombinations);
+		return Functions[Features];
+	}
+
+	static FBatchSubstepFunction GetBatch(uint32 Features)
+	{
+		static const FBatchSubstepFunction Functions[] = { &FTetherSimulation::PerformBatchSubstep<FeatureCombinations>... };
+		check(Features < SubstepFeature_NumCombinations);
+		return Functions[Features];
+	}
+};
+
+/** Scale of the constraint forces of a series which has simulated for the given time, easing them in over the start of its simulation */
+static float GetConstraintsForceMultiplier(const FTetherSimulationParams& Params, float SimulatedTime)
+{
+	const float ConstraintsEaseInTime = Params.SimulationOptions.ConstraintsEaseInTime;
+	return ConstraintsEaseInTime > 0.f ? FMath::Min(SimulatedTime / ConstraintsEaseInTime, 1.f) : 1.f;
+}
+
+void FTetherSimulation::BuildConstraintProgram(const FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series)
+{
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+
+	// Ends of the series are held along the spline tangent if the anchor point there uses tangents
+	bool bUseStartTangent = false;
+	bool bUseEndTangent = false;
+	if (Series.GetNumSegments() > 0)
+	{
+		const int32 StartPointUniqueId = Series.GetSegmentConst(0)->SegmentUniqueId;
+		const int32 EndPointUniqueId = Series.GetLastSegmentConst()->SegmentUniqueId + 1;
+		bUseStartTangent = Params.SegmentParams.IsValidIndex(StartPointUniqueId) && Params.SegmentParams[StartPointUniqueId].SimulationOptions.ShouldUseSplineTangents();
+		bUseEndTangent = Params.SegmentParams.IsValidIndex(EndPointUniqueId) && Params.SegmentParams[EndPointUniqueId].SimulationOptions.ShouldUseSplineTangents();
+	}
+
+	Series.BuildConstraintProgram(Params.SimulationOptions.bEnableStiffness, bUseStartTangent, bUseEndTangent);
+}
+
+uint32 FTetherSimulation::GetSubstepFeatures(const FTetherSimulationContext& SimulationContext, const FTetherProxySimulationSegmentSeries& Series)
+{
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+
+	uint32 Features = SubstepFeature_None;
+	if (Params.SimulationOptions.bEnableCollision)
+	{
+		Features |= SubstepFeature_Collision;
+	}
+	if (Params.SimulationOptions.ShouldUseSelfCollision())
+	{
+		Features |= SubstepFeature_SelfCollision;
+	}
+
+#ifdef TETHER_SIMULATION_DEBUG_CHECKS
+	const bool bDebugChecks = true;
+#else
+	const bool bDebugChecks = false;
+#endif
+	if (bDebugChecks
+		|| CVarSubstepDebug.GetValueOnAnyThread() > 0
+		|| CVarDebugSubstep.GetValueOnAnyThread() >= 0
+		|| CVarDebugParticle.GetValueOnAnyThread() >= 0
+		|| UE_LOG_ACTIVE(LogTetherSimulation, VeryVerbose))
+	{
+		Features |= SubstepFeature_Debug;
+	}
+
+	return Features;
+}
+
 FTetherSimulationResultInfo FTetherSimulation::PerformSimulation(FTetherSimulationModel& Model, float SimulationTime, const FTetherSimulationParams& Params, FProgressCancel* Progress)
+{
+	FTetherSimulationParticleStore ParticleStore;
+	FTetherSimulationScratch Scratch;
+	return PerformSimulation(Model, SimulationTime, Params, ParticleStore, Scratch, Progress);
+}
+
+FTetherSimulationResultInfo FTetherSimulation::PerformSimulation(FTetherSimulationModel& Model, float SimulationTime, const FTetherSimulationParams& Params, FTetherSimulationParticleStore& ParticleStore, FTetherSimulationScratch& Scratch, FProgressCancel* Progress)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::PerformSimulation"))
-	
+
+	FTetherSimulationResultInfo ResultInfo;
+	FTetherSimulationContext SimulationContext(Model, Params, ResultInfo, ParticleStore, Scratch);
+
+	// Gather particles into contiguous storage for the duration of the simulation
+	ParticleStore.Build(Model);
+	ParticleStore.InitCollisionCaches(Params.SimulationOptions.ShouldUseCollisionCulling(), Params.SimulationOptions.ShouldUseContactCaching());
+
+	TArray<FTetherProxySimulationSegmentSeries> SegmentsToSimulate;
+	BeginSimulation(SimulationContext, SimulationTime, SegmentsToSimulate);
+
+	const bool bSimulateEntirely = SimulationTime <= 0.f;
+	float SimulationTimeRemainder = SimulationTime;
+
+	// Series only interact through self-collision, so without it they can be simulated at the same time
+	const bool bParallelSeries = bSimulateEntirely && Params.SimulationOptions.bEnableParallelSeries && !Params.SimulationOptions.ShouldUseSelfCollision() && SegmentsToSimulate.Num() > 1;
+	if(bParallelSeries)
+	{
+		SimulateSeriesInParallel(SimulationContext, SegmentsToSimulate, Progress);
+		ResultInfo.bParallelSeries = true;
+		if(Progress && Progress->Cancelled())
+		{
+			WriteParticlesToModel(SimulationContext, SegmentsToSimulate);
+			return ResultInfo;
+		}
+	}
+
+	int32 SegmentSeriesIndex = bParallelSeries ? SegmentsToSimulate.Num() : 0;
+	int32 SegmentSubstepNum = 0;
+
+	const float MinSubstepTime = GetMinSubstepTime(Params);
+	while(bSimulateEntirely || SimulationTimeRemainder >= MinSubstepTime)
+	{
+		if(Progress && Progress->Cancelled())
+		{
+			WriteParticlesToModel(SimulationContext, SegmentsToSimulate);
+			return ResultInfo;
+		}
+		
+		if(!SegmentsToSimulate.IsValidIndex(SegmentSeriesIndex))
+		{
+			// Out of range, which means there are no more segments to simulate
+			break;
+		}
+
+		if(SimulateSeriesSubstep(SimulationContext, SegmentsToSimulate[SegmentSeriesIndex], SegmentSeriesIndex, SegmentSubstepNum, bSimulateEntirely, SimulationTimeRemainder))
+		{
+			SegmentSubstepNum++;
+		}
+		else
+		{
+			// Series has finished, move to next
+			SegmentSeriesIndex++;
+			SegmentSubstepNum = 0;
+		}
+	}
+
+	EndSimulation(SimulationContext, SegmentsToSimulate, SimulationTime, SimulationTimeRemainder);
+
+	return ResultInfo;
+}
+
+bool FTetherSimulation::CanSimulateInBatch(const FTetherSimulationParams& Params)
+{
+	// Particle indices of self-collision bodies are relative to their own model, so those models can't share a particle store
+	// Adaptive substeps differ from model to model, so those models can't share substeps
+	return !Params.SimulationOptions.ShouldUseSelfCollision() && !Params.SimulationOptions.bEnableAdaptiveSubstepping;
+}
+
+bool FTetherSimulation::CanShareBatchSubsteps(const FTetherSimulationParams& A, const FTetherSimulationParams& B)
+{
+	const FTetherCableSimulationOptions& OptionsA = A.SimulationOptions;
+	const FTetherCableSimulationOptions& OptionsB = B.SimulationOptions;
+	return OptionsA.SubstepTime == OptionsB.SubstepTime
+		&& A.CableForce == B.CableForce
+		&& OptionsA.Drag == OptionsB.Drag
+		&& OptionsA.bEnableParticleSleeping == OptionsB.bEnableParticleSleeping
+		&& OptionsA.Integrator == OptionsB.Integrator
+		&& OptionsA.ConstraintSolver == OptionsB.ConstraintSolver
+		&& OptionsA.bEnableCollision == OptionsB.bEnableCollision;
+}
+
+TArray<FTetherSimulationResultInfo> FTetherSimulation::PerformBatchSimulation(TArrayView<FTetherSimulationModel*> Models, TArrayView<const FTetherSimulationParams*> Params, float SimulationTime, FProgressCancel* Progress)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::PerformBatchSimulation"))
+
+	TArray<FTetherSimulationResultInfo> ResultInfos;
+	if(!ensure(Models.Num() == Params.Num()))
+	{
+		return ResultInfos;
+	}
+	ResultInfos.SetNum(Models.Num());
+
+	// Group the models that can take their substeps together, and simulate the rest alone
+	TArray<TArray<int32>> Groups;
+	for(int32 ModelIndex = 0; ModelIndex < Models.Num(); ModelIndex++)
+	{
+		if(!CanSimulateInBatch(*Params[ModelIndex]))
+		{
+			continue;
+		}
+		TArray<int32>* Group = Groups.FindByPredicate([&](const TArray<int32>& ExistingGroup)
+		{
+			return CanShareBatchSubsteps(*Params[ExistingGroup[0]], *Params[ModelIndex]);
+		});
+		if(Group)
+		{
+			Group->Add(ModelIndex);
+		}
+		else
+		{
+			Groups.Add({ ModelIndex });
+		}
+	}
+	TArray<bool> Batched;
+	Batched.SetNumZeroed(Models.Num());
+	for(const TArray<int32>& Group : Groups)
+	{
+		for(const int32 ModelIndex : Group)
+		{
+			Batched[ModelIndex] = Group.Num() > 1;
+		}
+	}
+	for(int32 ModelIndex = 0; ModelIndex < Models.Num(); ModelIndex++)
+	{
+		if(!Batched[ModelIndex])
+		{
+			ResultInfos[ModelIndex] = PerformSimulation(*Models[ModelIndex], SimulationTime, *Params[ModelIndex], Progress);
+		}
+	}
+
+	// Pack the particles of the models of each group one after another into one store, and share one set of substep temporaries between them
+	FTetherSimulationParticleStore ParticleStore;
+	FTetherSimulationScratch Scratch;
+	int32 NumParticles = 0;
+	int32 NumSegments = 0;
+	int32 NumBatchedModels = 0;
+	bool bAnyCollisionCulling = false;
+	bool bAnyContactCaching = false;
+	for(int32 ModelIndex = 0; ModelIndex < Models.Num(); ModelIndex++)
+	{
+		if(Batched[ModelIndex])
+		{
+			NumParticles += Models[ModelIndex]->GetNumParticles();
+			NumSegments += Models[ModelIndex]->Segments.Num();
+			NumBatchedModels++;
+			bAnyCollisionCulling |= Params[ModelIndex]->SimulationOptions.ShouldUseCollisionCulling();
+			bAnyContactCaching |= Params[ModelIndex]->SimulationOptions.ShouldUseContactCaching();
+		}
+	}
+	if(NumBatchedModels == 0)
+	{
+		return ResultInfos;
+	}
+	ParticleStore.Reserve(NumParticles, NumSegments, NumBatchedModels);
+	for(const TArray<int32>& Group : Groups)
+	{
+		if(Group.Num() > 1)
+		{
+			for(const int32 ModelIndex : Group)
+			{
+				ParticleStore.Append(*Models[ModelIndex]);
+			}
+		}
+	}
+	ParticleStore.InitCollisionCaches(bAnyCollisionCulling, bAnyContactCaching);
+
+	struct FBatchedModel
+	{
+		FTetherSimulationContext Context;
+		TArray<FTetherProxySimulationSegmentSeries> SegmentsToSimulate;
+		int32 SegmentSeriesIndex = 0;
+		int32 SegmentSubstepNum = 0;
+		float SimulationTimeRemainder = 0.f;
+		bool bFinished = false;
+	};
+	TArray<FBatchedModel> Batch;
+	Batch.Reserve(NumBatchedModels);
+	TArray<FBatchSeriesSubstep> SeriesSubsteps;
+	TArray<FBatchedModel*> SteppedModels;
+	const bool bSimulateEntirely = SimulationTime <= 0.f;
+	for(const TArray<int32>& Group : Groups)
+	{
+		if(Group.Num() <= 1)
+		{
+			continue;
+		}
+
+		const int32 FirstInGroup = Batch.Num();
+		for(const int32 ModelIndex : Group)
+		{
+			FBatchedModel& BatchedModel = Batch.Add_GetRef({ FTetherSimulationContext(*Models[ModelIndex], *Params[ModelIndex], ResultInfos[ModelIndex], ParticleStore, Scratch) });
+			BatchedModel.Context.ParticleStoreModelIndex = Batch.Num() - 1;
+			BatchedModel.SimulationTimeRemainder = SimulationTime;
+			BeginSimulation(BatchedModel.Context, SimulationTime, BatchedModel.SegmentsToSimulate);
+			ResultInfos[ModelIndex].bBatched = true;
+		}
+		const TArrayView<FBatchedModel> GroupModels = MakeArrayView(Batch).Slice(FirstInGroup, Group.Num());
+		SeriesSubsteps.Reset(Group.Num());
+		SteppedModels.Reset(Group.Num());
+
+		// Every model takes its next substep at the same time, each stepping through its series in order exactly as if it were simulated alone
+		const float SubstepTime = Params[Group[0]]->SimulationOptions.SubstepTime;
+		while(!(Progress && Progress->Cancelled()))
+		{
+			SeriesSubsteps.Reset();
+			SteppedModels.Reset();
+			uint32 Features = SubstepFeature_None;
+			for(FBatchedModel& BatchedModel : GroupModels)
+			{
+				while(!BatchedModel.bFinished)
+				{
+					float SeriesSubstepTime = 0.f;
+					if(!(bSimulateEntirely || BatchedModel.SimulationTimeRemainder >= GetMinSubstepTime(BatchedModel.Context.Params))
+						|| !BatchedModel.SegmentsToSimulate.IsValidIndex(BatchedModel.SegmentSeriesIndex))
+					{
+						BatchedModel.bFinished = true;
+					}
+					else if(BeginSeriesSubstep(BatchedModel.Context, BatchedModel.SegmentsToSimulate[BatchedModel.SegmentSeriesIndex], BatchedModel.SegmentSeriesIndex, bSimulateEntirely, BatchedModel.SimulationTimeRemainder, SeriesSubstepTime))
+					{
+						FTetherProxySimulationSegmentSeries& Series = BatchedModel.SegmentsToSimulate[BatchedModel.SegmentSeriesIndex];
+						check(SeriesSubstepTime == SubstepTime);
+						Features = Series.SubstepFeatures;
+						SeriesSubsteps.Add({ &BatchedModel.Context, &Series, BatchedModel.SegmentSubstepNum });
+						SteppedModels.Add(&BatchedModel);
+						break;
+					}
+					else
+					{
+						// Series has finished, move to next
+						BatchedModel.SegmentSeriesIndex++;
+						BatchedModel.SegmentSubstepNum = 0;
+					}
+				}
+			}
+
+			if(SeriesSubsteps.Num() == 0)
+			{
+				break;
+			}
+
+			// Models of a group share every option their substep features are chosen from
+			TSubstepTable<TMakeIntegerSequence<uint32, SubstepFeature_NumCombinations>>::GetBatch(Features)(SeriesSubsteps, SubstepTime);
+			for(FBatchedModel* BatchedModel : SteppedModels)
+			{
+				BatchedModel->SimulationTimeRemainder -= SubstepTime;
+				BatchedModel->Context.ResultInfo.NumSubsteps++;
+				BatchedModel->SegmentSubstepNum++;
+			}
+		}
+	}
+
+	for(FBatchedModel& BatchedModel : Batch)
+	{
+		if(BatchedModel.bFinished)
+		{
+			EndSimulation(BatchedModel.Context, BatchedModel.SegmentsToSimulate, SimulationTime, BatchedModel.SimulationTimeRemainder);
+		}
+		else
+		{
+			// Cancelled
+			WriteParticlesToModel(BatchedModel.Context, BatchedModel.SegmentsToSimulate);
+		}
+	}
+
+	return ResultInfos;
+}
+
+void FTetherSimulation::BeginSimulation(FTetherSimulationContext& SimulationContext, float SimulationTime, TArray<FTetherProxySimulationSegmentSeries>& OutSegmentsToSimulate)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::BeginSimulation"))
+
+	FTetherSimulationModel& Model = SimulationContext.Model;
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	FTetherSimulationResultInfo& ResultInfo = SimulationContext.ResultInfo;
+
 	ensure(Params.World.IsValid(false, true) || !Params.SimulationOptions.bEnableCollision);
 
 	Params.SimulationOptions.CheckSelfCollisionOptions();
 
 	FTetherPhysicsUtils::CheckBodyInstances(Params.BodyInstances);
 
-	FTetherSimulationResultInfo ResultInfo;
-	FTetherSimulationContext SimulationContext(Model, Params, ResultInfo);
-
 	UE_LOG(LogTetherSimulation, Verbose, TEXT("-- Begin Tether simulation: %s --"), *Params.SimulationName);
 	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: IsInGameThread (synchronous): %i"), *Params.SimulationName, IsInGameThread());
 	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Initial model state hash: %i"), *Params.SimulationName, GetTypeHash(Model));
@@ -72,15 +452,33 @@ FTetherSimulationResultInfo FTetherSimulation::PerformSimulation(FTetherSimulati
 	const int32 NumSubsteps = SimulationTime / SubstepTime;
 	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: SimulationTime: %f, SubstepTime: %f, NumSubsteps: %i"), *Params.SimulationName, SimulationTime, SubstepTime, NumSubsteps);
 	
-	TArray<FTetherProxySimulationSegmentSeries> SegmentsToSimulate = Params.MakeSegmentSeriesToSimulate(Model, true);
+	OutSegmentsToSimulate = Params.MakeSegmentSeriesToSimulate(Model, true);
+
+	// The model's particles must already have been gathered into the store
+	for(FTetherProxySimulationSegmentSeries& Series : OutSegmentsToSimulate)
+	{
+		Series.BindParticleStore(SimulationContext.ParticleStore, SimulationContext.ParticleStoreModelIndex);
+		if(Params.SimulationOptions.bEnableTethers)
+		{
+			Series.BuildTethers();
+		}
+		BuildConstraintProgram(SimulationContext, Series);
+		Series.SubstepFeatures = GetSubstepFeatures(SimulationContext, Series);
+	}
+
+	// Reserved before solving any series analytically, which uses the same temporaries
+	SimulationContext.Scratch.Reserve(OutSegmentsToSimulate);
 
 	ResultInfo.SimulatedSegments = {};
 
+	// Reserved up front so that resolving hits doesn't allocate in the middle of substeps
+	ResultInfo.HitComponents.Reserve(ReservedHitComponents);
+
 	// Log segments
-	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: %i segment series:"), *Params.SimulationName, SegmentsToSimulate.Num());
-	for (int32 i = 0; i < SegmentsToSimulate.Num(); i++)
+	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: %i segment series:"), *Params.SimulationName, OutSegmentsToSimulate.Num());
+	for (int32 i = 0; i < OutSegmentsToSimulate.Num(); i++)
 	{
-		const FTetherSimulationSegmentSeries& Series = SegmentsToSimulate[i];
+		const FTetherSimulationSegmentSeries& Series = OutSegmentsToSimulate[i];
 		TArray<int32> Segments = Series.GetSegmentUniqueIds();
 		ResultInfo.SimulatedSegments.Append(Segments);
 		UE_LOG(LogTetherSimulation, Verbose, TEXT("%s:     %i: "), *Params.SimulationName, i);
@@ -94,354 +492,1755 @@ FTetherSimulationResultInfo FTetherSimulation::PerformSimulation(FTetherSimulati
 	}
 
 	const bool bSimulateEntirely = SimulationTime <= 0.f;
-	float SimulationTimeRemainder = SimulationTime;
-	int32 SegmentSeriesIndex = 0;
-	int32 SegmentSubstepNum = 0;
 
-	while(bSimulateEntirely || SimulationTimeRemainder >= SubstepTime)
+	// Series that can hang freely are solved in closed form and skip to the end of their simulation, when simulating the entire duration
+	if(bSimulateEntirely && Params.SimulationOptions.bEnableAnalyticSolve)
 	{
-		if(Progress && Progress->Cancelled())
+		for(FTetherProxySimulationSegmentSeries& Series : OutSegmentsToSimulate)
 		{
-			return ResultInfo;
+			if(Series.GetSimulatedTime() < Params.SimulationOptions.SimulationDuration && SolveSeriesAnalytically(SimulationContext, Series))
+			{
+				Series.AddSimulatedTime(Params.SimulationOptions.SimulationDuration - Series.GetSimulatedTime());
+				ResultInfo.AnalyticSegments.Append(Series.GetSegmentUniqueIds());
+			}
 		}
-		
-		if(!SegmentsToSimulate.IsValidIndex(SegmentSeriesIndex))
+		ResultInfo.bAnalytic = ResultInfo.AnalyticSegments.Num() > 0 && ResultInfo.AnalyticSegments.Num() == ResultInfo.SimulatedSegments.Num();
+		UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Solved %i segments analytically"), *Params.SimulationName, ResultInfo.AnalyticSegments.Num());
+	}
+}
+
+void FTetherSimulation::EndSimulation(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SimulatedSeries, float SimulationTime, float SimulationTimeRemainder)
+{
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	FTetherSimulationResultInfo& ResultInfo = SimulationContext.ResultInfo;
+
+	WriteParticlesToModel(SimulationContext, SimulatedSeries);
+
+	// Only free particles sleep, and series only share fixed particles, so no particle is counted twice
+	for(const FTetherProxySimulationSegmentSeries& Series : SimulatedSeries)
+	{
+		for(int32 ParticleIdx = Series.ParticleStoreOffset; ParticleIdx < Series.ParticleStoreOffset + Series.ParticleStoreNum; ParticleIdx++)
 		{
-			// Out of range, which means there are no more segments to simulate
-			break;
+			ResultInfo.NumSleepingParticles += SimulationContext.ParticleStore.IsSleeping(ParticleIdx);
 		}
-		
-		FTetherProxySimulationSegmentSeries& Segment = SegmentsToSimulate[SegmentSeriesIndex];
-		if(Segment.GetSimulatedTime() + SubstepTime > Params.SimulationOptions.SimulationDuration )
+	}
+
+	UE_LOG(LogTetherSimulation, Verbose, TEXT("-- End Tether simulation: %s --"), *Params.SimulationName);
+
+	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Num collision hits: %i"), *Params.SimulationName, ResultInfo.NumCollisionHits);
+
+	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Num collision sweeps: %i, culled: %i, cached contact hits: %i"), *Params.SimulationName, ResultInfo.NumCollisionSweeps, ResultInfo.NumCulledCollisionSweeps, ResultInfo.NumCachedContactHits);
+
+	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Num substeps: %i"), *Params.SimulationName, ResultInfo.NumSubsteps);
+
+	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Simulated model state hash: %i"), *Params.SimulationName, GetTypeHash(SimulationContext.Model));
+
+	ResultInfo.SimulationTimeRemainder = SimulationTimeRemainder;
+	ResultInfo.SimulatedTime = SimulationTime - SimulationTimeRemainder;
+}
+
+float FTetherSimulation::GetMinSubstepTime(const FTetherSimulationParams& Params)
+{
+	return Params.SimulationOptions.bEnableAdaptiveSubstepping ? Params.SimulationOptions.MinSubstepTime : Params.SimulationOptions.SubstepTime;
+}
+
+bool FTetherSimulation::BeginSeriesSubstep(FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series, int32 SeriesIndex, bool bSimulateEntirely, float SimulationTimeRemainder, float& OutSubstepTime)
+{
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	FTetherSimulationResultInfo& ResultInfo = SimulationContext.ResultInfo;
+
+	// Adaptive substeps are clamped to end exactly at the simulation duration, so allow for rounding when accumulating them
+	const bool bAdaptiveSubstepping = Params.SimulationOptions.bEnableAdaptiveSubstepping;
+	const float MinSubstepTime = GetMinSubstepTime(Params);
+	const float MaxSubstepOvershoot = bAdaptiveSubstepping ? KINDA_SMALL_NUMBER : 0.f;
+
+	float SeriesSubstepTime = Params.SimulationOptions.SubstepTime;
+	if(bAdaptiveSubstepping)
+	{
+		// Never step past the end of the series or the time we were asked to simulate, unless that would need a substep shorter than the minimum
+		SeriesSubstepTime = ComputeAdaptiveSubstepTime(SimulationContext, Series);
+		SeriesSubstepTime = FMath::Min(SeriesSubstepTime, Params.SimulationOptions.SimulationDuration - Series.GetSimulatedTime());
+		if(!bSimulateEntirely)
 		{
-			// Time would exceed the current segment, move to next;
-			SegmentSeriesIndex++;
-			SegmentSubstepNum = 0;
-			continue;
+			SeriesSubstepTime = FMath::Min(SeriesSubstepTime, SimulationTimeRemainder);
+		}
+		SeriesSubstepTime = FMath::Max(SeriesSubstepTime, MinSubstepTime);
+	}
+
+	if(Series.GetSimulatedTime() + SeriesSubstepTime > Params.SimulationOptions.SimulationDuration + MaxSubstepOvershoot)
+	{
+		// Time would exceed the series
+		return false;
+	}
+
+	if(Params.SimulationOptions.bEnableRestDetection && Series.GetRestTime() >= Params.SimulationOptions.RestTimeWindow)
+	{
+		// Series has settled, skip to the end of its simulation
+		UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Series %i settled at %f"), *Params.SimulationName, SeriesIndex, Series.GetSimulatedTime());
+		ResultInfo.NumSettledSeries++;
+		ResultInfo.SettledTime = Series.GetSimulatedTime();
+		Series.AddSimulatedTime(Params.SimulationOptions.SimulationDuration - Series.GetSimulatedTime());
+		return false;
+	}
+
+	OutSubstepTime = SeriesSubstepTime;
+	return true;
+}
+
+bool FTetherSimulation::SimulateSeriesSubstep(FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series, int32 SeriesIndex, int32 SubstepNum, bool bSimulateEntirely, float& SimulationTimeRemainder)
+{
+	float SeriesSubstepTime = 0.f;
+	if(!BeginSeriesSubstep(SimulationContext, Series, SeriesIndex, bSimulateEntirely, SimulationTimeRemainder, SeriesSubstepTime))
+	{
+		return false;
+	}
+
+	// Simulate the series, with a substep specialised for the features it uses
+	TSubstepTable<TMakeIntegerSequence<uint32, SubstepFeature_NumCombinations>>::Get(Series.SubstepFeatures)(SimulationContext, MakeArrayView(&Series, 1), SeriesSubstepTime, SubstepNum);
+	SimulationTimeRemainder -= SeriesSubstepTime;
+	SimulationContext.ResultInfo.NumSubsteps++;
+	return true;
+}
+
+void FTetherSimulation::SimulateSeriesInParallel(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SeriesToSimulate, FProgressCancel* Progress)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SimulateSeriesInParallel"))
+
+	// Each series gets its own results and scratch space, sharing only the particle store
+	// Neighbouring series share their fixed anchor particle in the store, so every kernel must leave fixed particles unwritten, and only write the series' own free particles
+	TArray<FTetherSimulationResultInfo> SeriesResults;
+	SeriesResults.SetNum(SeriesToSimulate.Num());
+	ParallelFor(SeriesToSimulate.Num(), [&](int32 SeriesIndex)
+	{
+		FTetherProxySimulationSegmentSeries& Series = SeriesToSimulate[SeriesIndex];
+		FTetherSimulationScratch SeriesScratch;
+		FTetherSimulationContext SeriesContext(SimulationContext.Model, SimulationContext.Params, SeriesResults[SeriesIndex], SimulationContext.ParticleStore, SeriesScratch);
+		SeriesContext.ParticleStoreModelIndex = SimulationContext.ParticleStoreModelIndex;
+		SeriesScratch.Reserve(MakeArrayView(&Series, 1));
+		SeriesResults[SeriesIndex].HitComponents.Reserve(ReservedHitComponents);
+
+		float SimulationTimeRemainder = 0.f;
+		int32 SubstepNum = 0;
+		while(!(Progress && Progress->Cancelled()) && SimulateSeriesSubstep(SeriesContext, Series, SeriesIndex, SubstepNum, true, SimulationTimeRemainder))
+		{
+			SubstepNum++;
+		}
+	});
+
+	// Merge in series order, so the results are the same as simulating the series one after another
+	FTetherSimulationResultInfo& ResultInfo = SimulationContext.ResultInfo;
+	for(const FTetherSimulationResultInfo& SeriesResult : SeriesResults)
+	{
+		for(const TWeakObjectPtr<UPrimitiveComponent>& HitComponent : SeriesResult.HitComponents)
+		{
+			ResultInfo.HitComponents.AddUnique(HitComponent);
+		}
+		ResultInfo.NumCollisionHits += SeriesResult.NumCollisionHits;
+		ResultInfo.NumCollisionSweeps += SeriesResult.NumCollisionSweeps;
+		ResultInfo.NumCulledCollisionSweeps += SeriesResult.NumCulledCollisionSweeps;
+		ResultInfo.NumCachedContactHits += SeriesResult.NumCachedContactHits;
+		ResultInfo.NumSubsteps += SeriesResult.NumSubsteps;
+		if(SeriesResult.NumSettledSeries > 0)
+		{
+			ResultInfo.NumSettledSeries += SeriesResult.NumSettledSeries;
+			ResultInfo.SettledTime = SeriesResult.SettledTime;
+		}
+	}
+}
+
+void FTetherSimulation::WriteParticlesToModel(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SimulatedSeries)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::WriteParticlesToModel"))
+
+	for(FTetherProxySimulationSegmentSeries& Series : SimulatedSeries)
+	{
+		for(FTetherSimulationSegment* Segment : Series.Segments)
+		{
+			SimulationContext.ParticleStore.WriteToSegment(*Segment, SimulationContext.ParticleStoreModelIndex);
+		}
+	}
+}
+
+float FTetherSimulation::ComputeAdaptiveSubstepTime(const FTetherSimulationContext& SimulationContext, const FTetherProxySimulationSegmentSeries& Series)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::ComputeAdaptiveSubstepTime"))
+
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	const FTetherCableSimulationOptions& Options = Params.SimulationOptions;
+	const FTetherSimulationParticleStore& ParticleStore = SimulationContext.ParticleStore;
+	const FVector* Positions = ParticleStore.Positions.GetData();
+	const FVector* OldPositions = ParticleStore.OldPositions.GetData();
+
+	const int32 FirstParticle = Series.ParticleStoreOffset;
+	const int32 EndParticle = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+	const float ParticleSegmentLength = Series.GetParticleSegmentLength();
+
+	// Between substeps, old positions always hold the displacement over the nominal substep time
+	float MaxDisplacementSquared = 0.f;
+	float MaxDistanceSquared = 0.f;
+	for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle; ParticleIdx++)
+	{
+		MaxDisplacementSquared = FMath::Max<float>(MaxDisplacementSquared, FVector::DistSquared(Positions[ParticleIdx], OldPositions[ParticleIdx]));
+		if (ParticleIdx < EndParticle - 1)
+		{
+			MaxDistanceSquared = FMath::Max<float>(MaxDistanceSquared, FVector::DistSquared(Positions[ParticleIdx], Positions[ParticleIdx + 1]));
+		}
+	}
+
+	float AdaptiveSubstepTime = Options.MaxSubstepTime;
+
+	// Particles may travel at most a fraction of the collision width, or of the distance between particles if not colliding, in a single substep
+	const float TravelWidth = Options.bEnableCollision && Params.CollisionWidth > 0.f ? Params.CollisionWidth : ParticleSegmentLength;
+	const float MaxSpeed = FMath::Sqrt(MaxDisplacementSquared) / Options.SubstepTime;
+	if (MaxSpeed > KINDA_SMALL_NUMBER)
+	{
+		AdaptiveSubstepTime = FMath::Min(AdaptiveSubstepTime, Options.AdaptiveSubstepMaxTravel * TravelWidth / MaxSpeed);
+	}
+
+	// Shorten the substep in proportion to how far constraints are stretched beyond the threshold
+	// Slack constraints are ignored, since they don't make the solver unstable
+	if (ParticleSegmentLength > 0.f)
+	{
+		const float MaxStretch = (FMath::Sqrt(MaxDistanceSquared) - ParticleSegmentLength) / ParticleSegmentLength;
+		if (MaxStretch > Options.AdaptiveSubstepStretchThreshold)
+		{
+			AdaptiveSubstepTime = FMath::Min(AdaptiveSubstepTime, Options.MaxSubstepTime * Options.AdaptiveSubstepStretchThreshold / MaxStretch);
+		}
+	}
+
+	return FMath::Clamp(AdaptiveSubstepTime, Options.MinSubstepTime, FMath::Max(Options.MinSubstepTime, Options.MaxSubstepTime));
+}
+
+/**
+ * Scales the implied velocity (position - old position) of each particle in the series
+ * Used to move between the nominal substep time, which old positions are stored relative to between substeps, and the time of an adaptive substep
+ */
+void RescaleParticleVelocities(FTetherSimulationParticleStore& ParticleStore, const FTetherProxySimulationSegmentSeries& Series, float VelocityScale)
+{
+	FVector* Positions = ParticleStore.Positions.GetData();
+	FVector* OldPositions = ParticleStore.OldPositions.GetData();
+	const float* InverseMasses = ParticleStore.InverseMasses.GetData();
+
+	// Fixed and sleeping particles have no velocity, so are left alone, which also leaves anchor particles shared with neighbouring series untouched
+	const int32 EndParticle = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+	for (int32 ParticleIdx = Series.ParticleStoreOffset; ParticleIdx < EndParticle; ParticleIdx++)
+	{
+		if (InverseMasses[ParticleIdx] > 0.f)
+		{
+			OldPositions[ParticleIdx] = Positions[ParticleIdx] - (Positions[ParticleIdx] - OldPositions[ParticleIdx]) * VelocityScale;
+		}
+	}
+}
+
+FString GetDebugParticleString(const FTetherSimulationParticle& Particle)
+{
+	FString Output = TEXT("");
+	FTetherSimulationParticle::StaticStruct()->ExportText(Output, &Particle, nullptr, nullptr, (PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited | PPF_IncludeTransient), nullptr);
+	return Output;
+}
+
+FString GetDebugParticleString(const FTetherSimulationParticleRef& Particle)
+{
+	FTetherSimulationParticle DebugParticle(Particle.bFree, Particle.Position);
+	DebugParticle.OldPosition = Particle.OldPosition;
+	DebugParticle.ParticleUniqueId = Particle.ParticleUniqueId;
+	return GetDebugParticleString(DebugParticle);
+}
+
+FString GetDebugParticleString(const FTetherSimulationParticleStore& ParticleStore)
+{
+	const int32 DebugParticleId = CVarDebugParticle.GetValueOnAnyThread();
+	if (DebugParticleId >= 0)
+	{
+		const int32 DebugParticleIndex = ParticleStore.FindParticleUniqueId(DebugParticleId);
+		if(DebugParticleIndex != INDEX_NONE)
+		{
+			return GetDebugParticleString(ParticleStore.MakeParticle(DebugParticleIndex));
+		}
+	}
+	return FString();
+}
+
+void UpdateSelfCollisionBodies(const FTetherSimulationSubstepContext& SubstepContext)
+{
+	// Bodies exist for all particles up until and including those being simulated, and body indices match particle store indices
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Update Particle Bodies"));
+	const FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+
+	// Find the range of particles in the segment we are simulating
+	ensure(SubstepContext.SegmentsToSimulate.Num() == 1);
+	const FTetherProxySimulationSegmentSeries& Series = SubstepContext.SegmentsToSimulate.Last();
+	const int32 FirstBodyIndex = Series.ParticleStoreOffset;
+	const int32 NumBodies = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+	check(NumBodies <= SubstepContext.SimulationContext.Params.BodyInstances.Num());
+	for (int32 i = FirstBodyIndex; i < NumBodies; i++)
+	{
+		FBodyInstance* BodyInstance = SubstepContext.SimulationContext.Params.BodyInstances[i];
+		check(BodyInstance->IsValidBodyInstance());
+		check(FPhysicsInterface::IsValid(BodyInstance->GetPhysicsActorHandle()));
+		FTransform Transform = BodyInstance->GetUnrealWorldTransform();
+		Transform.SetLocation(ParticleStore.Positions[i]);
+		BodyInstance->SetBodyTransform(Transform, ETeleportType::TeleportPhysics);
+	}
+}
+
+void UpdateRestTime(const FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Series, float SubstepTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Update Rest Time"));
+
+	const FTetherCableSimulationOptions& Options = SubstepContext.SimulationContext.Params.SimulationOptions;
+	const FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	const FVector* Positions = ParticleStore.Positions.GetData();
+	const FVector* OldPositions = ParticleStore.OldPositions.GetData();
+
+	const int32 FirstParticle = Series.ParticleStoreOffset;
+	const int32 EndParticle = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+
+	// Compare squared values to avoid a square root per particle
+	const float MaxDisplacement = Options.RestSpeedThreshold * SubstepTime;
+	const float MaxDisplacementSquared = MaxDisplacement * MaxDisplacement;
+	float MaxParticleDisplacementSquared = 0.f;
+	for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle; ParticleIdx++)
+	{
+		MaxParticleDisplacementSquared = FMath::Max<float>(MaxParticleDisplacementSquared, FVector::DistSquared(Positions[ParticleIdx], OldPositions[ParticleIdx]));
+	}
+
+	bool bAtRest = MaxParticleDisplacementSquared <= MaxDisplacementSquared;
+	if (bAtRest)
+	{
+		const float ParticleSegmentLength = Series.GetParticleSegmentLength();
+		const float MaxError = Options.RestConstraintErrorThreshold * ParticleSegmentLength;
+		const float MinDistanceSquared = FMath::Square(FMath::Max(ParticleSegmentLength - MaxError, 0.f));
+		const float MaxDistanceSquared = FMath::Square(ParticleSegmentLength + MaxError);
+		for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle - 1; ParticleIdx++)
+		{
+			const float DistanceSquared = FVector::DistSquared(Positions[ParticleIdx], Positions[ParticleIdx + 1]);
+			if (DistanceSquared < MinDistanceSquared || DistanceSquared > MaxDistanceSquared)
+			{
+				bAtRest = false;
+				break;
+			}
+		}
+	}
+
+	Series.SetRestTime(bAtRest ? Series.GetRestTime() + SubstepTime : 0.f);
+}
+
+void WakeParticles(const FTetherSimulationSubstepContext& SubstepContext, const FTetherProxySimulationSegmentSeries& Series)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Wake Particles"));
+
+	const FTetherCableSimulationOptions& Options = SubstepContext.SimulationContext.Params.SimulationOptions;
+	FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+
+	const int32 FirstParticle = Series.ParticleStoreOffset;
+	const int32 EndParticle = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+
+	const float ParticleSegmentLength = Series.GetParticleSegmentLength();
+	const float WakeError = Options.ParticleWakeThreshold * ParticleSegmentLength;
+
+	// Sleeping particles are held in place, so any pull from their neighbours shows up as error in the constraints between them
+	for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle - 1; ParticleIdx++)
+	{
+		if (!ParticleStore.IsSleeping(ParticleIdx) && !ParticleStore.IsSleeping(ParticleIdx + 1))
+		{
+			continue;
+		}
+
+		const float Distance = FVector::Dist(ParticleStore.Positions[ParticleIdx], ParticleStore.Positions[ParticleIdx + 1]);
+		if (FMath::Abs(Distance - ParticleSegmentLength) > WakeError)
+		{
+			// Wake both particles of the constraint, and their neighbours
+			for (int32 WakeIdx = FMath::Max(ParticleIdx - 1, FirstParticle); WakeIdx <= FMath::Min(ParticleIdx + 2, EndParticle - 1); WakeIdx++)
+			{
+				if (ParticleStore.IsSleeping(WakeIdx))
+				{
+					ParticleStore.SetSleeping(WakeIdx, false);
+				}
+			}
+		}
+	}
+}
+
+void UpdateParticleSleeping(const FTetherSimulationSubstepContext& SubstepContext, const FTetherProxySimulationSegmentSeries& Series, float SubstepTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Update Particle Sleeping"));
+
+	const FTetherCableSimulationOptions& Options = SubstepContext.SimulationContext.Params.SimulationOptions;
+	FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+
+	const float MaxDisplacement = Options.ParticleSleepSpeedThreshold * SubstepTime;
+	const float MaxDisplacementSquared = MaxDisplacement * MaxDisplacement;
+
+	const int32 FirstParticle = Series.ParticleStoreOffset;
+	const int32 EndParticle = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+	for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle; ParticleIdx++)
+	{
+		if (!ParticleStore.IsFree(ParticleIdx))
+		{
+			continue;
+		}
+
+		if (FVector::DistSquared(ParticleStore.Positions[ParticleIdx], ParticleStore.OldPositions[ParticleIdx]) > MaxDisplacementSquared)
+		{
+			ParticleStore.StillTimes[ParticleIdx] = 0.f;
+			continue;
+		}
+
+		ParticleStore.StillTimes[ParticleIdx] += SubstepTime;
+		if (ParticleStore.StillTimes[ParticleIdx] >= Options.ParticleSleepTime)
+		{
+			ParticleStore.SetSleeping(ParticleIdx, true);
+		}
+	}
+}
+
+bool FTetherSimulation::SolveSeriesAnalytically(FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SolveSeriesAnalytically"));
+
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	FTetherSimulationParticleStore& ParticleStore = SimulationContext.ParticleStore;
+	check(Series.ParticleStore == &ParticleStore);
+
+	const int32 NumParticles = Series.ParticleStoreNum;
+	if(NumParticles < 3 || Params.SimulationOptions.bEnableStiffness)
+	{
+		return false;
+	}
+
+	const int32 StartPointUniqueId = Series.GetSegmentConst(0)->SegmentUniqueId;
+	const int32 EndPointUniqueId = Series.GetLastSegmentConst()->SegmentUniqueId + 1;
+	const bool bFixedStartTangent = Params.SegmentParams.IsValidIndex(StartPointUniqueId) && Params.SegmentParams[StartPointUniqueId].SimulationOptions.ShouldUseSplineTangents();
+	const bool bFixedEndTangent = Params.SegmentParams.IsValidIndex(EndPointUniqueId) && Params.SegmentParams[EndPointUniqueId].SimulationOptions.ShouldUseSplineTangents();
+	if(bFixedStartTangent || bFixedEndTangent)
+	{
+		return false;
+	}
+
+	// The series must hang freely between fixed particles at each end
+	const int32 FirstParticle = Series.ParticleStoreOffset;
+	const int32 LastParticle = Series.ParticleStoreOffset + NumParticles - 1;
+	if(ParticleStore.IsFree(FirstParticle) || ParticleStore.IsFree(LastParticle))
+	{
+		return false;
+	}
+	for(int32 ParticleIdx = FirstParticle + 1; ParticleIdx < LastParticle; ParticleIdx++)
+	{
+		if(!ParticleStore.IsFree(ParticleIdx))
+		{
+			return false;
+		}
+	}
+
+	FTetherCatenary Catenary;
+	const double Length = Series.GetLength();
+	if(!FTetherCatenary::Solve(ParticleStore.Positions[FirstParticle], ParticleStore.Positions[LastParticle], Length, Params.CableForce, Catenary))
+	{
+		return false;
+	}
+
+	TArray<FVector>& CatenaryPositions = SimulationContext.Scratch.CatenaryPositions;
+	CatenaryPositions.SetNumUninitialized(NumParticles, false);
+	CatenaryPositions[0] = ParticleStore.Positions[FirstParticle];
+	CatenaryPositions[NumParticles - 1] = ParticleStore.Positions[LastParticle];
+	FBox Bounds(CatenaryPositions[0], CatenaryPositions[0]);
+	for(int32 i = 1; i < NumParticles - 1; i++)
+	{
+		CatenaryPositions[i] = Catenary.GetLocationAtDistance(Length * i / (NumParticles - 1));
+		Bounds += CatenaryPositions[i];
+	}
+	Bounds += CatenaryPositions[NumParticles - 1];
+
+	if(Params.SimulationOptions.bEnableCollision)
+	{
+		if(!Params.World.IsValid(false, true))
+		{
+			return false;
+		}
+		UWorld* World = Params.World.Get();
+
+		ECollisionChannel TraceChannel = ECC_PhysicsBody;
+		FCollisionResponseParams ResponseParams = FCollisionResponseParams();
+		UCollisionProfile::GetChannelAndResponseParams(Params.SimulationOptions.CollisionProfile.Name, TraceChannel, ResponseParams);
+
+		const float CollisionRadius = 0.5f * Params.CollisionWidth;
+		const UPrimitiveComponent* OwnComponent = Params.Component.IsValid(false, true) ? Params.Component.Get() : nullptr;
+		const int32 SeriesSegmentIndex = ParticleStore.FindSegmentWithParticle(LastParticle);
+
+		// Same rules as collision while simulating: ignore triggers, and bodies of this cable that belong to this series or haven't been simulated yet
+		auto IsBlockingHit = [&](const UPrimitiveComponent* Component, int32 Item, const AActor* Actor)
+		{
+			if(IsValid(Actor) && Actor->IsA<ATriggerBase>())
+			{
+				return false;
+			}
+			if(OwnComponent && OwnComponent == Component)
+			{
+				if(Item < 0 || (Item >= FirstParticle && Item <= LastParticle) || !ParticleStore.IsValidIndex(Item))
+				{
+					return false;
+				}
+				if(ParticleStore.FindSegmentWithParticle(Item) > SeriesSegmentIndex)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		// Sweep against the collision snapshot if it covers the catenary
+		// Otherwise check the whole catenary against the world at once, and only sweep along it if something is within its bounds
+		const FTetherCollisionSnapshot* CollisionSnapshot = Params.CollisionSnapshot.Get();
+		const bool bUseCollisionSnapshot = CollisionSnapshot && CollisionSnapshot->Contains(Bounds.Min, Bounds.Max, CollisionRadius);
+		bool bAnyOverlap = bUseCollisionSnapshot;
+		if(!bUseCollisionSnapshot)
+		{
+			TArray<FOverlapResult>& Overlaps = SimulationContext.Scratch.CollisionOverlaps;
+			Overlaps.Reset();
+			World->OverlapMultiByChannel(Overlaps, Bounds.GetCenter(), FQuat::Identity, TraceChannel, FCollisionShape::MakeBox(Bounds.GetExtent() + FVector(CollisionRadius)), Params.CollisionQueryParams, ResponseParams);
+			for(const FOverlapResult& Overlap : Overlaps)
+			{
+				if(IsBlockingHit(Overlap.GetComponent(), Overlap.ItemIndex, Overlap.GetActor()))
+				{
+					bAnyOverlap = true;
+					break;
+				}
+			}
+		}
+
+		if(bAnyOverlap)
+		{
+			const FCollisionShape CollisionShape = FCollisionShape::MakeSphere(CollisionRadius);
+			TArray<FHitResult>& Hits = SimulationContext.Scratch.CollisionHits;
+			for(int32 i = 0; i < NumParticles - 1; i++)
+			{
+				Hits.Reset();
+				if(bUseCollisionSnapshot)
+				{
+					CollisionSnapshot->SweepSphere(Hits, CatenaryPositions[i], CatenaryPositions[i + 1], CollisionRadius);
+				}
+				else
+				{
+					World->SweepMultiByChannel(Hits, CatenaryPositions[i], CatenaryPositions[i + 1], FQuat::Identity, TraceChannel, CollisionShape, Params.CollisionQueryParams, ResponseParams);
+				}
+				for(const FHitResult& Hit : Hits)
+				{
+					if(IsBlockingHit(Hit.GetComponent(), Hit.Item, Hit.GetActor()))
+					{
+						UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Catenary of series starting at segment %i intersects %s, simulating instead"), *Params.SimulationName, StartPointUniqueId, *GetNameSafe(Hit.GetComponent()));
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	for(int32 i = 1; i < NumParticles - 1; i++)
+	{
+		ParticleStore.Positions[FirstParticle + i] = CatenaryPositions[i];
+		ParticleStore.OldPositions[FirstParticle + i] = CatenaryPositions[i];
+	}
+
+	if(Params.SimulationOptions.ShouldUseSelfCollision())
+	{
+		// Move the bodies of this series so later series collide with its final shape
+		UpdateSelfCollisionBodies(FTetherSimulationSubstepContext(SimulationContext, MakeArrayView(&Series, 1)));
+	}
+
+	return true;
+}
+
+template<uint32 Features>
+void FTetherSimulation::PerformSimulationSubstep(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SegmentsToSimulate, float SubstepTime, int32 SubstepNum)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::PerformSimulationSubstep"))
+
+	constexpr bool bCollision = (Features & SubstepFeature_Collision) != 0;
+	constexpr bool bSelfCollision = (Features & SubstepFeature_SelfCollision) != 0;
+	constexpr bool bDebug = (Features & SubstepFeature_Debug) != 0;
+
+	FTetherSimulationModel& Model = SimulationContext.Model;
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	const FTetherSimulationParticleStore& ParticleStore = SimulationContext.ParticleStore;
+
+	FTetherSimulationSubstepContext SubstepContext(SimulationContext, SegmentsToSimulate);
+	SubstepContext.SubstepNum = SubstepNum;
+	SubstepContext.SubstepTime = SubstepTime;
+
+	// Velocity is implied by old positions over the nominal substep time, so rescale it when taking a substep of a different length
+	const float NominalSubstepTime = Params.SimulationOptions.SubstepTime;
+	const bool bRescaleVelocities = SubstepTime != NominalSubstepTime && SegmentsToSimulate[0].HasAnyParticles();
+	if (bRescaleVelocities)
+	{
+		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+		{
+			RescaleParticleVelocities(SimulationContext.ParticleStore, Segment, SubstepTime / NominalSubstepTime);
+		}
+	}
+
+	if(SegmentsToSimulate[0].HasAnyParticles())
+	{
+		if (bDebug)
+		{
+			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, substep start: %s"), *GetDebugParticleString(ParticleStore));
+		}
+
+		const float SimulatedTime = SegmentsToSimulate[0].GetSimulatedTime();
+		const float ForceMultiplier = GetConstraintsForceMultiplier(Params, SimulatedTime);
+		if (bDebug)
+		{
+			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: SimulatedTime: %f, ForceMultiplier: %f"), *Params.SimulationName, SubstepNum, SimulatedTime, ForceMultiplier);
+		}
+
+		const bool bImplicit = Params.SimulationOptions.Integrator == ETetherIntegrator::Implicit;
+		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+		{
+			// Solve new position and velocity from external forces
+			VerletIntegrateSegment(SubstepContext, Segment, SubstepTime);
+			if (bImplicit)
+			{
+				ImplicitIntegrateSegment(SubstepContext, Segment, SubstepTime, ForceMultiplier);
+			}
+		}
+
+		if (bDebug)
+		{
+			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, after integration: %s"), *GetDebugParticleString(ParticleStore));
+		}
+
+		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+		{
+			// Apply forces between particles
+			SolveConstraintsForSegment<Features>(SubstepContext, Segment, ForceMultiplier);
+		}
+
+		if (bDebug)
+		{
+			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, after constraints: %s"), *GetDebugParticleString(ParticleStore));
+		}
+
+		if (Params.SimulationOptions.bEnableParticleSleeping)
+		{
+			for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+			{
+				WakeParticles(SubstepContext, Segment);
+			}
+		}
+
+		if (bCollision)
+		{
+			for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+			{
+				PerformCollision<Features>(SubstepContext, Segment, ForceMultiplier);
+			}
+
+			if (bDebug)
+			{
+				UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, after collision: %s"), *GetDebugParticleString(ParticleStore));
+			}
+		}
+
+		// Only start counting rest time once constraints are fully applied, since the cable is still being pulled into shape while they ease in
+		if (Params.SimulationOptions.bEnableRestDetection && ForceMultiplier >= 1.f)
+		{
+			for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+			{
+				UpdateRestTime(SubstepContext, Segment, SubstepTime);
+			}
+		}
+
+		// Likewise, particles may only sleep once constraints are fully applied
+		if (Params.SimulationOptions.bEnableParticleSleeping && ForceMultiplier >= 1.f)
+		{
+			for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+			{
+				UpdateParticleSleeping(SubstepContext, Segment, SubstepTime);
+			}
+		}
+
+		// Update bodies for self-collision
+		if (bSelfCollision)
+		{
+			UpdateSelfCollisionBodies(SubstepContext);
+			if (bDebug)
+			{
+				UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: Bodies hash: %i"), *Params.SimulationName, SubstepNum, GetBodyInstanceHash(Params));
+			}
+		}
+
+		if (bDebug)
+		{
+			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: Particles hash: %i"), *Params.SimulationName, SubstepNum, GetTypeHash(ParticleStore));
+			if (CVarDebugSubstep.GetValueOnAnyThread() == SubstepNum)
+			{
+				// Bring the model up to date with the simulating particles so it can be dumped
+				WriteParticlesToModel(SimulationContext, SegmentsToSimulate);
+				FString Output = TEXT("");
+				FTetherSimulationModel::StaticStruct()->ExportText(Output, &Model, nullptr, nullptr, (PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited | PPF_IncludeTransient), nullptr);
+				UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s"), *Output);
+			}
+		}
+	}
+
+	if (bRescaleVelocities)
+	{
+		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+		{
+			RescaleParticleVelocities(SimulationContext.ParticleStore, Segment, NominalSubstepTime / SubstepTime);
+		}
+	}
+
+	// Add simulation time, even for empty segments
+	for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+	{
+		Segment.AddSimulatedTime(SubstepTime);
+	}
+
+}
+
+template<uint32 Features>
+void FTetherSimulation::PerformBatchSubstep(TArrayView<FBatchSeriesSubstep> SeriesSubsteps, float SubstepTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::PerformBatchSubstep"))
+
+	constexpr bool bCollision = (Features & SubstepFeature_Collision) != 0;
+
+	// Every model of the batch integrates its particles the same way, so take how from the first
+	const FTetherSimulationParams& BatchParams = SeriesSubsteps[0].SimulationContext->Params;
+	FTetherSimulationParticleStore& ParticleStore = SeriesSubsteps[0].SimulationContext->ParticleStore;
+	const FVector ForceStep = (SubstepTime * SubstepTime) * BatchParams.CableForce;
+
+	// Integrate the particles of every series in one pass, joining series that follow each other in the store into one range
+	// Models of a batch are packed one after another, so a batch of single series cables is integrated in a single range
+	int32 RangeStart = INDEX_NONE;
+	int32 RangeEnd = INDEX_NONE;
+	for (const FBatchSeriesSubstep& SeriesSubstep : SeriesSubsteps)
+	{
+		const FTetherProxySimulationSegmentSeries& Series = *SeriesSubstep.Series;
+		check(Series.ParticleStore == &ParticleStore);
+		if (!Series.HasAnyParticles())
+		{
+			continue;
+		}
+
+		const int32 SeriesEnd = Series.ParticleStoreOffset + Series.ParticleStoreNum;
+		if (Series.ParticleStoreOffset != RangeEnd)
+		{
+			if (RangeStart != INDEX_NONE)
+			{
+				IntegrateParticles(ParticleStore, RangeStart, RangeEnd, ForceStep, BatchParams.SimulationOptions.Drag, BatchParams.SimulationOptions.bEnableParticleSleeping);
+			}
+			RangeStart = Series.ParticleStoreOffset;
+		}
+		RangeEnd = SeriesEnd;
+	}
+	if (RangeStart != INDEX_NONE)
+	{
+		IntegrateParticles(ParticleStore, RangeStart, RangeEnd, ForceStep, BatchParams.SimulationOptions.Drag, BatchParams.SimulationOptions.bEnableParticleSleeping);
+	}
+
+	// Solve the constraint programs of every series in one pass, each with its own model's options
+	const bool bImplicit = BatchParams.SimulationOptions.Integrator == ETetherIntegrator::Implicit;
+	for (const FBatchSeriesSubstep& SeriesSubstep : SeriesSubsteps)
+	{
+		FTetherProxySimulationSegmentSeries& Series = *SeriesSubstep.Series;
+		if (!Series.HasAnyParticles())
+		{
+			continue;
+		}
+
+		FTetherSimulationSubstepContext SubstepContext(*SeriesSubstep.SimulationContext, MakeArrayView(&Series, 1));
+		SubstepContext.SubstepNum = SeriesSubstep.SubstepNum;
+		SubstepContext.SubstepTime = SubstepTime;
+
+		const float ForceMultiplier = GetConstraintsForceMultiplier(SubstepContext.SimulationContext.Params, Series.GetSimulatedTime());
+		if (bImplicit)
+		{
+			ImplicitIntegrateSegment(SubstepContext, Series, SubstepTime, ForceMultiplier);
+		}
+		SolveConstraintsForSegment<Features>(SubstepContext, Series, ForceMultiplier);
+	}
+
+	// Collision and the rest of the substep are per cable, in the same order as a substep of the model alone
+	for (const FBatchSeriesSubstep& SeriesSubstep : SeriesSubsteps)
+	{
+		FTetherProxySimulationSegmentSeries& Series = *SeriesSubstep.Series;
+		if (Series.HasAnyParticles())
+		{
+			FTetherSimulationSubstepContext SubstepContext(*SeriesSubstep.SimulationContext, MakeArrayView(&Series, 1));
+			SubstepContext.SubstepNum = SeriesSubstep.SubstepNum;
+			SubstepContext.SubstepTime = SubstepTime;
+
+			const FTetherCableSimulationOptions& Options = SubstepContext.SimulationContext.Params.SimulationOptions;
+			const float ForceMultiplier = GetConstraintsForceMultiplier(SubstepContext.SimulationContext.Params, Series.GetSimulatedTime());
+			if (Options.bEnableParticleSleeping)
+			{
+				WakeParticles(SubstepContext, Series);
+			}
+			if (bCollision)
+			{
+				PerformCollision<Features>(SubstepContext, Series, ForceMultiplier);
+			}
+			if (Options.bEnableRestDetection && ForceMultiplier >= 1.f)
+			{
+				UpdateRestTime(SubstepContext, Series, SubstepTime);
+			}
+			if (Options.bEnableParticleSleeping && ForceMultiplier >= 1.f)
+			{
+				UpdateParticleSleeping(SubstepContext, Series, SubstepTime);
+			}
+		}
+
+		Series.AddSimulatedTime(SubstepTime);
+	}
+}
+
+#if UE_VERSION_OLDER_THAN(5,0,0)
+typedef float FTetherReal;
+typedef VectorRegister FTetherVectorRegister;
+template<typename RealType> using TTetherVectorRegister = VectorRegister;
+#else
+typedef FVector::FReal FTetherReal;
+typedef TVectorRegisterType<FVector::FReal> FTetherVectorRegister;
+template<typename RealType> using TTetherVectorRegister = TVectorRegisterType<RealType>;
+#endif
+
+/**
+ * Calls Func with each run [RunStart, RunEnd) of consecutive free particles in the given range, skipping runs of fixed or sleeping particles
+ * If not skipping inactive particles, Func is called once with the whole range
+ */
+template<typename FuncType>
+static void ForEachActiveParticleRun(const FTetherSimulationParticleStore& ParticleStore, int32 FirstParticle, int32 EndParticle, bool bSkipInactiveParticles, FuncType Func)
+{
+	if (!bSkipInactiveParticles)
+	{
+		Func(FirstParticle, EndParticle);
+		return;
+	}
+
+	const float* InverseMasses = ParticleStore.InverseMasses.GetData();
+	int32 RunStart = FirstParticle;
+	while (RunStart < EndParticle)
+	{
+		while (RunStart < EndParticle && InverseMasses[RunStart] <= 0.f)
+		{
+			RunStart++;
+		}
+		int32 RunEnd = RunStart;
+		while (RunEnd < EndParticle && InverseMasses[RunEnd] > 0.f)
+		{
+			RunEnd++;
+		}
+		if (RunEnd > RunStart)
+		{
+			Func(RunStart, RunEnd);
+		}
+		RunStart = RunEnd;
+	}
+}
+
+/** Number of particles or constraints processed together by vectorized kernels */
+static constexpr int32 VectorBlockSize = 4;
+
+/** Reference implementation of particle integration, one particle at a time */
+static void IntegrateParticlesScalar(FVector* Positions, FVector* OldPositions, const float* InverseMasses, int32 FirstParticle, int32 EndParticle, const FVector& ForceStep, float Drag)
+{
+	for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle; ParticleIdx++)
+	{
+		if (InverseMasses[ParticleIdx] > 0.f)
+		{
+			FVector& Position = Positions[ParticleIdx];
+			FVector& OldPosition = OldPositions[ParticleIdx];
+
+			// Find velocity
+			FVector Velocity = Position - OldPosition;
+
+			if(Drag > 0.f)
+			{
+				const float Speed = Velocity.Size();
+				const FVector DragForce = -0.5f * Speed * Speed * Drag * Velocity.GetSafeNormal();
+				Velocity += DragForce;
+			}
+
+			// Update position
+			const FVector NewPosition = Position + Velocity + ForceStep;
+
+			OldPosition = Position;
+			Position = NewPosition;
+		}
+	}
+}
+
+/**
+ * Integrates a contiguous range of particles in blocks, with the X, Y and Z of every particle in a block each held in one vector register, so each instruction integrates the whole block
+ * Fixed particles are masked out of the result using their inverse mass rather than branched over
+ * The last block may be partial, so every particle is integrated with the same arithmetic wherever the range starts, as when the range spans several cables of a batch
+ */
+template<bool bWithDrag>
+static void IntegrateParticlesVectorized(FVector* RESTRICT Positions, FVector* RESTRICT OldPositions, const float* RESTRICT InverseMasses, int32 FirstParticle, int32 EndParticle, const FVector& ForceStep, float Drag)
+{
+	static_assert(VectorBlockSize == 4, "Each block must fill the four lanes of a vector register");
+
+	const FTetherVectorRegister ForceStepX = VectorSetFloat1((FTetherReal)ForceStep.X);
+	const FTetherVectorRegister ForceStepY = VectorSetFloat1((FTetherReal)ForceStep.Y);
+	const FTetherVectorRegister ForceStepZ = VectorSetFloat1((FTetherReal)ForceStep.Z);
+	const FTetherVectorRegister HalfDragRegister = VectorSetFloat1((FTetherReal)(0.5f * Drag));
+	const FTetherVectorRegister ZeroRegister = VectorSetFloat1((FTetherReal)0.f);
+	const FTetherVectorRegister OneRegister = VectorSetFloat1((FTetherReal)1.f);
+
+	for (int32 BlockStart = FirstParticle; BlockStart < EndParticle; BlockStart += VectorBlockSize)
+	{
+		// Missing lanes of a partial block repeat its last particle, and aren't written back
+		const int32 NumLanes = FMath::Min(VectorBlockSize, EndParticle - BlockStart);
+		int32 Idx[VectorBlockSize];
+		for (int32 Lane = 0; Lane < VectorBlockSize; Lane++)
+		{
+			Idx[Lane] = BlockStart + FMath::Min(Lane, NumLanes - 1);
+		}
+		const FVector& P0 = Positions[Idx[0]];
+		const FVector& P1 = Positions[Idx[1]];
+		const FVector& P2 = Positions[Idx[2]];
+		const FVector& P3 = Positions[Idx[3]];
+		const FVector& O0 = OldPositions[Idx[0]];
+		const FVector& O1 = OldPositions[Idx[1]];
+		const FVector& O2 = OldPositions[Idx[2]];
+		const FVector& O3 = OldPositions[Idx[3]];
+
+		const FTetherVectorRegister PositionX = MakeVectorRegister(P0.X, P1.X, P2.X, P3.X);
+		const FTetherVectorRegister PositionY = MakeVectorRegister(P0.Y, P1.Y, P2.Y, P3.Y);
+		const FTetherVectorRegister PositionZ = MakeVectorRegister(P0.Z, P1.Z, P2.Z, P3.Z);
+		const FTetherVectorRegister OldPositionX = MakeVectorRegister(O0.X, O1.X, O2.X, O3.X);
+		const FTetherVectorRegister OldPositionY = MakeVectorRegister(O0.Y, O1.Y, O2.Y, O3.Y);
+		const FTetherVectorRegister OldPositionZ = MakeVectorRegister(O0.Z, O1.Z, O2.Z, O3.Z);
+		const FTetherVectorRegister FreeMask = VectorCompareGT(MakeVectorRegister((FTetherReal)InverseMasses[Idx[0]], (FTetherReal)InverseMasses[Idx[1]], (FTetherReal)InverseMasses[Idx[2]], (FTetherReal)InverseMasses[Idx[3]]), ZeroRegister);
+
+		FTetherVectorRegister VelocityX = VectorSubtract(PositionX, OldPositionX);
+		FTetherVectorRegister VelocityY = VectorSubtract(PositionY, OldPositionY);
+		FTetherVectorRegister VelocityZ = VectorSubtract(PositionZ, OldPositionZ);
+		if (bWithDrag)
+		{
+			// Drag of 0.5 * Drag * Speed^2 against the direction of travel, which scales velocity by (1 - 0.5 * Drag * Speed)
+			const FTetherVectorRegister SpeedSquared = VectorMultiplyAdd(VelocityX, VelocityX, VectorMultiplyAdd(VelocityY, VelocityY, VectorMultiply(VelocityZ, VelocityZ)));
+			const FTetherVectorRegister DragScale = VectorNegateMultiplyAdd(HalfDragRegister, VectorSqrt(SpeedSquared), OneRegister);
+			VelocityX = VectorMultiply(VelocityX, DragScale);
+			VelocityY = VectorMultiply(VelocityY, DragScale);
+			VelocityZ = VectorMultiply(VelocityZ, DragScale);
+		}
+
+		// Same order of operations as the scalar integration, so without drag both give exactly the same result
+		const FTetherVectorRegister NewPositionX = VectorAdd(VectorAdd(PositionX, VelocityX), ForceStepX);
+		const FTetherVectorRegister NewPositionY = VectorAdd(VectorAdd(PositionY, VelocityY), ForceStepY);
+		const FTetherVectorRegister NewPositionZ = VectorAdd(VectorAdd(PositionZ, VelocityZ), ForceStepZ);
+
+		FTetherReal Result[6][VectorBlockSize];
+		VectorStore(VectorSelect(FreeMask, NewPositionX, PositionX), Result[0]);
+		VectorStore(VectorSelect(FreeMask, NewPositionY, PositionY), Result[1]);
+		VectorStore(VectorSelect(FreeMask, NewPositionZ, PositionZ), Result[2]);
+		VectorStore(VectorSelect(FreeMask, PositionX, OldPositionX), Result[3]);
+		VectorStore(VectorSelect(FreeMask, PositionY, OldPositionY), Result[4]);
+		VectorStore(VectorSelect(FreeMask, PositionZ, OldPositionZ), Result[5]);
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			Positions[BlockStart + Lane] = FVector(Result[0][Lane], Result[1][Lane], Result[2][Lane]);
+			OldPositions[BlockStart + Lane] = FVector(Result[3][Lane], Result[4][Lane], Result[5][Lane]);
+		}
+	}
+}
+
+void FTetherSimulation::IntegrateParticles(FTetherSimulationParticleStore& ParticleStore, int32 FirstParticle, int32 EndParticle, const FVector& ForceStep, float Drag, bool bSkipInactiveParticles)
+{
+	FVector* Positions = ParticleStore.Positions.GetData();
+	FVector* OldPositions = ParticleStore.OldPositions.GetData();
+	const float* InverseMasses = ParticleStore.InverseMasses.GetData();
+
+	const bool bVectorized = CVarVectorizedIntegration.GetValueOnAnyThread() > 0;
+
+	// When particles can sleep, skip over runs of sleeping particles entirely
+	ForEachActiveParticleRun(ParticleStore, FirstParticle, EndParticle, bSkipInactiveParticles, [&](int32 RunStart, int32 RunEnd)
+	{
+		if (!bVectorized)
+		{
+			IntegrateParticlesScalar(Positions, OldPositions, InverseMasses, RunStart, RunEnd, ForceStep, Drag);
+		}
+		else if (Drag > 0.f)
+		{
+			IntegrateParticlesVectorized<true>(Positions, OldPositions, InverseMasses, RunStart, RunEnd, ForceStep, Drag);
+		}
+		else
+		{
+			IntegrateParticlesVectorized<false>(Positions, OldPositions, InverseMasses, RunStart, RunEnd, ForceStep, Drag);
+		}
+	});
+}
+
+void FTetherSimulation::VerletIntegrateSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float SubstepTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::VerletIntegrateSegment"))
+
+	const FTetherSimulationParams& Params = SubstepContext.SimulationContext.Params;
+	FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	check(Segment.ParticleStore == &ParticleStore);
+
+	const FVector* Positions = ParticleStore.Positions.GetData();
+	const float* InverseMasses = ParticleStore.InverseMasses.GetData();
+
+	const int32 FirstParticle = Segment.ParticleStoreOffset;
+	const int32 EndParticle = Segment.ParticleStoreOffset + Segment.ParticleStoreNum;
+
+	// The only force is the constant cable force, so its contribution to each free particle is the same
+	const FVector ForceStep = (SubstepTime * SubstepTime) * Params.CableForce;
+
+	// Fixed end particles never move, so leave them alone, as they may be anchors shared with neighbouring series simulating in parallel
+	// The vectorized integration writes back every particle in its range, including the fixed ones it masks out
+	int32 FirstIntegrated = FirstParticle;
+	int32 EndIntegrated = EndParticle;
+	if (FirstIntegrated < EndIntegrated && InverseMasses[FirstIntegrated] <= 0.f)
+	{
+		FirstIntegrated++;
+	}
+	if (EndIntegrated > FirstIntegrated && InverseMasses[EndIntegrated - 1] <= 0.f)
+	{
+		EndIntegrated--;
+	}
+
+	IntegrateParticles(ParticleStore, FirstIntegrated, EndIntegrated, ForceStep, Params.SimulationOptions.Drag, Params.SimulationOptions.bEnableParticleSleeping);
+
+#ifdef TETHER_SIMULATION_DEBUG_CHECKS
+	for (int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle; ParticleIdx++)
+	{
+		ensure(!Positions[ParticleIdx].ContainsNaN());
+		if (ParticleIdx > FirstParticle && InverseMasses[ParticleIdx] > 0.f)
+		{
+			ensure(Positions[ParticleIdx] != Positions[ParticleIdx - 1]);
+		}
+	}
+#endif
+}
+
+void FTetherSimulation::ImplicitIntegrateSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float SubstepTime, float ForceMultiplier)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::ImplicitIntegrateSegment"))
+
+	const FTetherCableSimulationOptions& Options = SubstepContext.SimulationContext.Params.SimulationOptions;
+	FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	FTetherSimulationScratch& Scratch = SubstepContext.SimulationContext.Scratch;
+	check(Segment.ParticleStore == &ParticleStore);
+
+	const int32 NumParticles = Segment.ParticleStoreNum;
+	const int32 NumSprings = NumParticles - 1;
+
+	// Backward Euler minimises |X - Y|^2 / 2 + SubstepTime^2 * E(X) for the prediction Y and spring energy E, so stiffness is scaled by the substep time squared
+	const float StiffnessStep = ForceMultiplier * Options.ImplicitStretchStiffness * SubstepTime * SubstepTime;
+	if (NumSprings < 1 || StiffnessStep <= 0.f)
+	{
+		return;
+	}
+
+	// Every particle has unit mass, and fixed and sleeping particles are held at their prediction
+	FVector* Positions = &ParticleStore.Positions[Segment.ParticleStoreOffset];
+	const float* InverseMasses = &ParticleStore.InverseMasses[Segment.ParticleStoreOffset];
+	const float RestLength = Segment.GetParticleSegmentLength();
+
+	TArray<FVector>& Displacement = Scratch.ImplicitDisplacement;
+	TArray<FVector>& Step = Scratch.ImplicitStep;
+	TArray<FVector>& Residual = Scratch.ImplicitResidual;
+	TArray<FVector>& Direction = Scratch.ImplicitDirection;
+	TArray<FVector>& Product = Scratch.ImplicitProduct;
+	TArray<FVector>& SpringDirections = Scratch.ImplicitSpringDirections;
+	TArray<float>& AxialStiffness = Scratch.ImplicitSpringAxialStiffness;
+	TArray<float>& LateralStiffness = Scratch.ImplicitSpringLateralStiffness;
+	Displacement.Reset();
+	Displacement.SetNumZeroed(NumParticles, false);
+	Step.SetNumUninitialized(NumParticles, false);
+	Residual.SetNumUninitialized(NumParticles, false);
+	Direction.SetNumUninitialized(NumParticles, false);
+	Product.SetNumUninitialized(NumParticles, false);
+	SpringDirections.SetNumUninitialized(NumSprings, false);
+	AxialStiffness.SetNumUninitialized(NumSprings, false);
+	LateralStiffness.SetNumUninitialized(NumSprings, false);
+
+	// Applies the Newton system I + SubstepTime^2 * K to a vector over the particles, where K is the Hessian of the spring energy, leaving fixed particles at zero
+	auto ApplySystem = [&](const TArray<FVector>& In, TArray<FVector>& Out)
+	{
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			Out[i] = In[i];
+		}
+		for (int32 S = 0; S < NumSprings; S++)
+		{
+			const FVector Relative = In[S + 1] - In[S];
+			const FVector Force = (AxialStiffness[S] * (SpringDirections[S] | Relative)) * SpringDirections[S] + LateralStiffness[S] * Relative;
+			Out[S] -= Force;
+			Out[S + 1] += Force;
+		}
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			if (InverseMasses[i] <= 0.f)
+			{
+				Out[i] = FVector::ZeroVector;
+			}
+		}
+	};
+
+	auto Dot = [NumParticles](const TArray<FVector>& A, const TArray<FVector>& B)
+	{
+		double Result = 0.;
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			Result += A[i] | B[i];
+		}
+		return Result;
+	};
+
+	for (int32 NewtonIdx = 0; NewtonIdx < Options.ImplicitNewtonIterations; NewtonIdx++)
+	{
+		// Linearise the springs about the current positions, and find the residual, which is the negative gradient of the objective
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			Residual[i] = -Displacement[i];
+		}
+		for (int32 S = 0; S < NumSprings; S++)
+		{
+			const FVector Delta = Positions[S + 1] - Positions[S];
+			const float Distance = Delta.Size();
+			const bool bDegenerate = Distance <= KINDA_SMALL_NUMBER;
+			SpringDirections[S] = bDegenerate ? FVector::ZeroVector : Delta / Distance;
+
+			// The lateral part of each spring's Hessian is clamped to zero while the spring is compressed, which keeps the system positive definite
+			const float Lateral = bDegenerate ? 0.f : FMath::Max(1.f - RestLength / Distance, 0.f);
+			AxialStiffness[S] = StiffnessStep * (1.f - Lateral);
+			LateralStiffness[S] = StiffnessStep * Lateral;
+
+			const FVector SpringForce = (StiffnessStep * (Distance - RestLength)) * SpringDirections[S];
+			Residual[S] += SpringForce;
+			Residual[S + 1] -= SpringForce;
+		}
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			if (InverseMasses[i] <= 0.f)
+			{
+				Residual[i] = FVector::ZeroVector;
+			}
+		}
+
+		double ResidualSquared = Dot(Residual, Residual);
+		if (ResidualSquared <= SMALL_NUMBER)
+		{
+			break;
+		}
+
+		// Conjugate gradient solve of the Newton step, from a zero initial guess
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			Step[i] = FVector::ZeroVector;
+			Direction[i] = Residual[i];
+		}
+		for (int32 SolverIdx = 0; SolverIdx < Options.ImplicitSolverIterations && ResidualSquared > SMALL_NUMBER; SolverIdx++)
+		{
+			ApplySystem(Direction, Product);
+			const double Curvature = Dot(Direction, Product);
+			if (Curvature <= SMALL_NUMBER)
+			{
+				break;
+			}
+			const double Alpha = ResidualSquared / Curvature;
+			for (int32 i = 0; i < NumParticles; i++)
+			{
+				Step[i] += Alpha * Direction[i];
+				Residual[i] -= Alpha * Product[i];
+			}
+			const double NewResidualSquared = Dot(Residual, Residual);
+			const double Beta = NewResidualSquared / ResidualSquared;
+			for (int32 i = 0; i < NumParticles; i++)
+			{
+				Direction[i] = Residual[i] + Beta * Direction[i];
+			}
+			ResidualSquared = NewResidualSquared;
+		}
+
+		// Fixed particles are never stepped, and are left alone as they may be anchors shared with neighbouring series simulating in parallel
+		for (int32 i = 0; i < NumParticles; i++)
+		{
+			if (InverseMasses[i] > 0.f)
+			{
+				Positions[i] += Step[i];
+				Displacement[i] += Step[i];
+			}
+		}
+	}
+
+#ifdef TETHER_SIMULATION_DEBUG_CHECKS
+	for (int32 i = 0; i < NumParticles; i++)
+	{
+		ensure(!Positions[i].ContainsNaN());
+	}
+#endif
+}
+
+/**
+ * Solves distance constraints [Begin, End) of a list one after another, each seeing the corrections of those before it
+ * Corrections are split between the particles by inverse mass, so fixed and synthetic particles are left in place without branching
+ * With debugging, checks each constraint is valid before and after solving
+ */
+template<bool bDebug, typename VectorType>
+static void SolveDistanceConstraints(VectorType* RESTRICT Positions, const FTetherSimulationConstraintList& Constraints, int32 Begin, int32 End, float ForceMultiplier)
+{
+	const int32* RESTRICT IndicesA = Constraints.IndicesA.GetData();
+	const int32* RESTRICT IndicesB = Constraints.IndicesB.GetData();
+	const float* RESTRICT RestLengths = Constraints.RestLengths.GetData();
+	const float* RESTRICT InverseMassesA = Constraints.InverseMassesA.GetData();
+	const float* RESTRICT InverseMassesB = Constraints.InverseMassesB.GetData();
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		VectorType& PositionA = Positions[IndicesA[i]];
+		VectorType& PositionB = Positions[IndicesB[i]];
+		const VectorType Delta = PositionB - PositionA;
+		const float CurrentDistance = FMath::Max<float>(Delta.Size(), SMALL_NUMBER);
+
+		if (bDebug)
+		{
+			ensure(RestLengths[i] > KINDA_SMALL_NUMBER);
+			ensure(CurrentDistance < BIG_NUMBER);
+			ensure(PositionA != PositionB);
+		}
+
+		const float InverseMassSum = FMath::Max(InverseMassesA[i] + InverseMassesB[i], SMALL_NUMBER);
+		const VectorType Correction = (ForceMultiplier * (CurrentDistance - RestLengths[i]) / (CurrentDistance * InverseMassSum)) * Delta;
+		PositionA += InverseMassesA[i] * Correction;
+		PositionB -= InverseMassesB[i] * Correction;
+
+		if (bDebug)
+		{
+			ensure(PositionA != PositionB);
+#ifdef TETHER_SIMULATION_DEBUG_CHECKS
+			ensure(!PositionA.ContainsNaN());
+			ensure(!PositionB.ContainsNaN());
+#endif
+		}
+	}
+}
+
+/**
+ * Solves distance constraints [Begin, End) of a list with XPBD, where each constraint is allowed to stretch depending on its compliance rather than the number of solver iterations
+ * @param	TimeScaledCompliance	Compliance of the constraints divided by the substep time squared
+ * @param	Lambdas					Lagrange multiplier accumulated by each constraint over the iterations of the current substep
+ */
+template<typename VectorType>
+static void SolveCompliantDistanceConstraints(VectorType* RESTRICT Positions, const FTetherSimulationConstraintList& Constraints, int32 Begin, int32 End, float TimeScaledCompliance, float* RESTRICT Lambdas, float ForceMultiplier)
+{
+	const int32* RESTRICT IndicesA = Constraints.IndicesA.GetData();
+	const int32* RESTRICT IndicesB = Constraints.IndicesB.GetData();
+	const float* RESTRICT RestLengths = Constraints.RestLengths.GetData();
+	const float* RESTRICT InverseMassesA = Constraints.InverseMassesA.GetData();
+	const float* RESTRICT InverseMassesB = Constraints.InverseMassesB.GetData();
+
+	for (int32 i = Begin; i < End; i++)
+	{
+		VectorType& PositionA = Positions[IndicesA[i]];
+		VectorType& PositionB = Positions[IndicesB[i]];
+		const VectorType Delta = PositionB - PositionA;
+		const float CurrentDistance = Delta.Size();
+
+		// Constraints that can't move anything, or have no direction, get no correction
+		const float Denominator = InverseMassesA[i] + InverseMassesB[i] + TimeScaledCompliance;
+		const bool bSolvable = Denominator > KINDA_SMALL_NUMBER && CurrentDistance > KINDA_SMALL_NUMBER;
+		const float InverseDenominator = bSolvable ? 1.f / Denominator : 0.f;
+		const VectorType Direction = Delta / FMath::Max<float>(CurrentDistance, KINDA_SMALL_NUMBER);
+
+		float& Lambda = Lambdas[i - Begin];
+		const float DeltaLambda = ForceMultiplier * (RestLengths[i] - CurrentDistance - TimeScaledCompliance * Lambda) * InverseDenominator;
+		Lambda += DeltaLambda;
+
+		PositionA -= (InverseMassesA[i] * DeltaLambda) * Direction;
+		PositionB += (InverseMassesB[i] * DeltaLambda) * Direction;
+
+#ifdef TETHER_SIMULATION_DEBUG_CHECKS
+		ensure(!PositionA.ContainsNaN());
+		ensure(!PositionB.ContainsNaN());
+#endif
+	}
+}
+
+/**
+ * Pulls each tethered particle of the program's chain back towards its anchor if it is further away than the length of cable between them
+ * Tethers only ever pull, so they have no effect on a cable that isn't stretched
+ */
+template<typename VectorType>
+static void SolveTetherConstraints(VectorType* RESTRICT Positions, const FTetherSimulationConstraintProgram& Program, float ForceMultiplier)
+{
+	const float* InverseMasses = Program.ChainInverseMasses.GetData();
+	const int32* TetherParticles = Program.TetherParticles.GetData();
+	const int32* TetherAnchors = Program.TetherAnchors.GetData();
+	const float* TetherLengths = Program.TetherLengths.GetData();
+
+	for (int32 i = 0; i < Program.TetherParticles.Num(); i++)
+	{
+		const int32 ParticleIdx = TetherParticles[i];
+		const VectorType Delta = Positions[ParticleIdx] - Positions[TetherAnchors[i]];
+		const float MaxDistance = TetherLengths[i];
+		const float DistanceSquared = Delta.SizeSquared();
+		if (DistanceSquared > MaxDistance * MaxDistance)
+		{
+			// Sleeping particles have zero inverse mass, so stay where they are
+			const float Distance = FMath::Sqrt(DistanceSquared);
+			Positions[ParticleIdx] -= (InverseMasses[ParticleIdx] * ForceMultiplier * (Distance - MaxDistance) / Distance) * Delta;
 		}
-
-		// Simulate the current segment
-		PerformSimulationSubstep(SimulationContext, { Segment }, SubstepTime, SegmentSubstepNum);
-		SimulationTimeRemainder -= SubstepTime;
-		SegmentSubstepNum++;
 	}
+}
 
-	for(FTetherSimulationSegmentSeries& Segment : SegmentsToSimulate)
+/**
+ * Solves a block of consecutive independent distance constraints of a list, holding each constraint in vector registers
+ * No particle may appear in more than one constraint of the block
+ */
+template<int32 BlockSize, typename VectorType>
+FORCEINLINE static void SolveDistanceConstraintBlock(VectorType* RESTRICT Positions, const FTetherSimulationConstraintList& Constraints, int32 First, float ForceMultiplier)
+{
+	// Single precision positions fit twice as many components in each vector register
+	typedef decltype(VectorType::X) RealType;
+	typedef TTetherVectorRegister<RealType> RegisterType;
+
+	const int32* IndicesA = &Constraints.IndicesA[First];
+	const int32* IndicesB = &Constraints.IndicesB[First];
+
+	RegisterType PositionA[BlockSize];
+	RegisterType PositionB[BlockSize];
+	RegisterType DesiredDistance[BlockSize];
+	RegisterType WeightA[BlockSize];
+	RegisterType WeightB[BlockSize];
+	for (int32 Lane = 0; Lane < BlockSize; Lane++)
 	{
-		Segment.SynchronizeConnectingParticles();
+		PositionA[Lane] = VectorLoadFloat3_W0(&Positions[IndicesA[Lane]].X);
+		PositionB[Lane] = VectorLoadFloat3_W0(&Positions[IndicesB[Lane]].X);
+		DesiredDistance[Lane] = VectorSetFloat1((RealType)Constraints.RestLengths[First + Lane]);
+
+		// Split the correction by inverse mass, so fixed particles are left in place without branching
+		const float InverseMassA = Constraints.InverseMassesA[First + Lane];
+		const float InverseMassB = Constraints.InverseMassesB[First + Lane];
+		const float InverseMassSum = FMath::Max(InverseMassA + InverseMassB, SMALL_NUMBER);
+		WeightA[Lane] = VectorSetFloat1((RealType)(ForceMultiplier * InverseMassA / InverseMassSum));
+		WeightB[Lane] = VectorSetFloat1((RealType)(ForceMultiplier * InverseMassB / InverseMassSum));
 	}
 
-	UE_LOG(LogTetherSimulation, Verbose, TEXT("-- End Tether simulation: %s --"), *Params.SimulationName);
-
-	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Num collision hits: %i"), *Params.SimulationName, ResultInfo.NumCollisionHits);
-
-	UE_LOG(LogTetherSimulation, Verbose, TEXT("%s: Simulated model state hash: %i"), *Params.SimulationName, GetTypeHash(Model));
+	const RegisterType MinDistance = VectorSetFloat1((RealType)SMALL_NUMBER);
+	for (int32 Lane = 0; Lane < BlockSize; Lane++)
+	{
+		const RegisterType Delta = VectorSubtract(PositionB[Lane], PositionA[Lane]);
+		const RegisterType CurrentDistance = VectorMax(VectorSqrt(VectorDot3(Delta, Delta)), MinDistance);
+		const RegisterType ErrorFactor = VectorDivide(VectorSubtract(CurrentDistance, DesiredDistance[Lane]), CurrentDistance);
+		const RegisterType Correction = VectorMultiply(ErrorFactor, Delta);
 
-	ResultInfo.SimulationTimeRemainder = SimulationTimeRemainder;
-	ResultInfo.SimulatedTime = SimulationTime - SimulationTimeRemainder;
-	
-	return ResultInfo;
+		VectorStoreFloat3(VectorMultiplyAdd(WeightA[Lane], Correction, PositionA[Lane]), &Positions[IndicesA[Lane]].X);
+		VectorStoreFloat3(VectorNegateMultiplyAdd(WeightB[Lane], Correction, PositionB[Lane]), &Positions[IndicesB[Lane]].X);
+	}
 }
 
-FString GetDebugParticleString(const FTetherSimulationParticle& Particle)
+/**
+ * Solves constraints [Begin, End) of a list, which must share no particles, in vectorized blocks
+ */
+template<typename VectorType>
+static void SolveDistanceConstraintColour(VectorType* Positions, const FTetherSimulationConstraintList& Constraints, int32 Begin, int32 End, float ForceMultiplier)
 {
-	FString Output = TEXT("");
-	FTetherSimulationParticle::StaticStruct()->ExportText(Output, &Particle, nullptr, nullptr, (PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited | PPF_IncludeTransient), nullptr);
-	return Output;
+	int32 ConstraintIdx = Begin;
+	for (; ConstraintIdx + VectorBlockSize <= End; ConstraintIdx += VectorBlockSize)
+	{
+		SolveDistanceConstraintBlock<VectorBlockSize>(Positions, Constraints, ConstraintIdx, ForceMultiplier);
+	}
+	for (; ConstraintIdx < End; ConstraintIdx++)
+	{
+		SolveDistanceConstraintBlock<1>(Positions, Constraints, ConstraintIdx, ForceMultiplier);
+	}
 }
 
-FString GetDebugParticleString(const FTetherSimulationModel& Model)
+/**
+ * Solves the constraints of a program one colour at a time, each colour being a set of independent constraints solved as a vectorized batch
+ * Colours were chosen when the program was compiled, splitting stretch and stiffness constraints into alternating sets along the chain
+ */
+template<typename VectorType>
+static void SolveConstraintsColoured(VectorType* Positions, const FTetherSimulationConstraintProgram& Program, int32 NumIterations, float ForceMultiplier)
 {
-	const int32 DebugParticleId = CVarDebugParticle.GetValueOnAnyThread();
-	if (DebugParticleId >= 0 && DebugParticleId < Model.GetNumParticles(true))
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SolveConstraintsColoured"));
+
+	for (int32 IterationIdx = 0; IterationIdx < NumIterations; IterationIdx++)
 	{
-		const FTetherSimulationParticle& DebugParticle = Model.GetParticleConst(DebugParticleId, true);
-		return GetDebugParticleString(DebugParticle);
+		for (int32 Colour = 0; Colour < Program.GetNumColours(); Colour++)
+		{
+			SolveDistanceConstraintColour(Positions, Program.ColouredConstraints, Program.ColourOffsets[Colour], Program.ColourOffsets[Colour + 1], ForceMultiplier);
+		}
+
+		SolveTetherConstraints(Positions, Program, ForceMultiplier);
 	}
-	return FString();
 }
 
-void UpdateSelfCollisionBodies(const FTetherSimulationSubstepContext& SubstepContext)
+/**
+ * Solves the stretch constraints of a program in a single pass
+ * The constraints are linearised about the current positions, giving a tridiagonal system in their Lagrange multipliers that is solved exactly with the Thomas algorithm
+ * Stiffness constraints couple every other particle so don't fit the tridiagonal system, and are instead solved with a single sweep beforehand
+ * @param	Directions				Scratch space for the direction of each stretch constraint
+ * @param	TimeScaledCompliance	Compliance of the stretch constraints divided by the substep time squared, zero for inextensible constraints
+ */
+template<bool bDebug, typename VectorType>
+static void SolveConstraintsDirect(FTetherSimulationContext& SimulationContext, VectorType* Positions, TArray<VectorType>& Directions, const FTetherSimulationConstraintProgram& Program, float TimeScaledCompliance, float ForceMultiplier)
 {
-	// The BodyProxy may not contain all the segments that will be simulated, but it will contain all of the ones with bodies relevant to this substep, including this segment and previous ones
-	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Update Particle Bodies"));
-	const FTetherProxySimulationSegmentSeries BodyProxy = SubstepContext.SimulationContext.Model.MakeSeriesUpTo(SubstepContext.SegmentsToSimulate.Last().Segments.Last()->SegmentUniqueId);
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SolveConstraintsDirect"));
 
-	// Find the index of the first particle in the segment we are simulating
-	ensure(SubstepContext.SegmentsToSimulate.Num() == 1);
-	const int32 FirstBodyIndex = BodyProxy.GetStartingParticleIndexForSegment(BodyProxy.IndexOfSegmentUniqueId(SubstepContext.SegmentsToSimulate.Last().GetSegmentConst(0)->SegmentUniqueId));
-	const int32 NumBodies = BodyProxy.GetNumParticles();
-	check(NumBodies <= SubstepContext.SimulationContext.Params.BodyInstances.Num());
-	for (int32 i = FirstBodyIndex; i < NumBodies; i++)
+	// Stretch constraint I is between chain particles I and I+1
+	const int32 NumParticleSegments = Program.NumStretchConstraints;
+	if (NumParticleSegments < 1)
 	{
-		FBodyInstance* BodyInstance = SubstepContext.SimulationContext.Params.BodyInstances[i];
-		check(BodyInstance->IsValidBodyInstance());
-		check(FPhysicsInterface::IsValid(BodyInstance->GetPhysicsActorHandle()));
-		FTransform Transform = BodyInstance->GetUnrealWorldTransform();
-		Transform.SetLocation(BodyProxy.GetParticleConst(i).Position);
-		BodyInstance->SetBodyTransform(Transform, ETeleportType::TeleportPhysics);
+		return;
 	}
-}
 
-void FTetherSimulation::PerformSimulationSubstep(FTetherSimulationContext& SimulationContext, TArray<FTetherProxySimulationSegmentSeries> SegmentsToSimulate, float SubstepTime, int32 SubstepNum)
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::PerformSimulationSubstep"))
+	SolveDistanceConstraints<bDebug>(Positions, Program.Constraints, Program.NumStretchConstraints, Program.Constraints.Num(), ForceMultiplier);
 
-	FTetherSimulationModel& Model = SimulationContext.Model;
-	const FTetherSimulationParams& Params = SimulationContext.Params;
+	const int32 NumChainParticles = NumParticleSegments + 1;
+	const float* InverseMasses = Program.ChainInverseMasses.GetData();
+	const float* RestLengths = Program.Constraints.RestLengths.GetData();
 
-	FTetherSimulationSubstepContext SubstepContext(SimulationContext, SegmentsToSimulate);
-	SubstepContext.SubstepNum = SubstepNum;
+	TArray<float>& Diagonal = SimulationContext.Scratch.ChainSystemDiagonal;
+	TArray<float>& Upper = SimulationContext.Scratch.ChainSystemUpper;
+	TArray<float>& Rhs = SimulationContext.Scratch.ChainSystemRhs;
+	Directions.SetNumUninitialized(NumParticleSegments, false);
+	Diagonal.SetNumUninitialized(NumParticleSegments, false);
+	Upper.SetNumUninitialized(NumParticleSegments, false);
+	Rhs.SetNumUninitialized(NumParticleSegments, false);
 
-	if(SegmentsToSimulate[0].HasAnyParticles())
+	// Constraint I between chain particles I and I+1 has gradient -N(I) for particle I, and N(I) for particle I+1
+	for (int32 I = 0; I < NumParticleSegments; I++)
 	{
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, substep start: %s"), *GetDebugParticleString(Model));
+		const VectorType Delta = Positions[I + 1] - Positions[I];
+		const float Distance = Delta.Size();
+		const bool bDegenerate = Distance <= KINDA_SMALL_NUMBER;
+		Directions[I] = bDegenerate ? VectorType::ZeroVector : Delta / Distance;
+		Rhs[I] = bDegenerate ? 0.f : RestLengths[I] - Distance;
+		Diagonal[I] = InverseMasses[I] + InverseMasses[I + 1] + TimeScaledCompliance;
+	}
 
-		const float SimulatedTime = SegmentsToSimulate[0].GetSimulatedTime();
-		const float ConstraintsEaseInTime = Params.SimulationOptions.ConstraintsEaseInTime;
-		const float ForceMultiplier = ConstraintsEaseInTime > 0.f ? FMath::Min(SimulatedTime / Params.SimulationOptions.ConstraintsEaseInTime, 1.f) : 1.f;
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: SimulatedTime: %f, ForceMultiplier: %f"), *Params.SimulationName, SubstepNum, SimulatedTime, ForceMultiplier);
+	// Neighbouring constraints are only coupled through the particle they share, so the system is symmetric and tridiagonal
+	auto Coupling = [&](int32 I) -> float
+	{
+		return -InverseMasses[I + 1] * (Directions[I] | Directions[I + 1]);
+	};
 
-		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+	// Forward elimination, leaving the modified upper coefficients in Upper and right hand side in Rhs
+	// Constraints between two fixed particles can't move anything, so are given a unit diagonal and a zero multiplier
+	for (int32 I = 0; I < NumParticleSegments; I++)
+	{
+		float Pivot = Diagonal[I];
+		float RhsI = Rhs[I];
+		if (I > 0)
 		{
-			// Solve new position and velocity from external forces
-			VerletIntegrateSegment(SubstepContext, Segment, SubstepTime);
+			const float Lower = Coupling(I - 1);
+			Pivot -= Lower * Upper[I - 1];
+			RhsI -= Lower * Rhs[I - 1];
 		}
-
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, after integration: %s"), *GetDebugParticleString(Model));
-
-		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+		if (Pivot <= SMALL_NUMBER)
 		{
-			// Apply forces between particles
-			SolveConstraintsForSegment(SubstepContext, Segment, ForceMultiplier);
+			Pivot = 1.f;
+			RhsI = 0.f;
 		}
+		Upper[I] = I < NumParticleSegments - 1 ? Coupling(I) / Pivot : 0.f;
+		Rhs[I] = RhsI / Pivot;
+	}
 
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, after constraints: %s"), *GetDebugParticleString(Model));
+	// Back substitution, leaving the Lagrange multiplier of each constraint in Rhs
+	for (int32 I = NumParticleSegments - 2; I >= 0; I--)
+	{
+		Rhs[I] -= Upper[I] * Rhs[I + 1];
+	}
 
-		for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
+	// Move each free particle by its inverse mass weighted share of the constraints on either side of it
+	for (int32 K = 0; K < NumChainParticles; K++)
+	{
+		const float InverseMass = InverseMasses[K];
+		if (InverseMass <= 0.f)
 		{
-			if (Params.SimulationOptions.bEnableCollision)
-			{
-				PerformCollision(SubstepContext, Segment, ForceMultiplier);
-			}
+			continue;
 		}
-
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, after collision: %s"), *GetDebugParticleString(Model));
-
-		// Update bodies for self-collision
-		if (Params.SimulationOptions.ShouldUseSelfCollision())
+		VectorType Correction = VectorType::ZeroVector;
+		if (K > 0)
 		{
-			UpdateSelfCollisionBodies(SubstepContext);
-			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: Bodies hash: %i"), *Params.SimulationName, SubstepNum, GetBodyInstanceHash(Params));
+			Correction += Directions[K - 1] * Rhs[K - 1];
 		}
-
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: Model hash: %i"), *Params.SimulationName, SubstepNum, GetTypeHash(Model));
-		if (CVarDebugSubstep.GetValueOnAnyThread() == SubstepNum)
+		if (K < NumParticleSegments)
 		{
-			FString Output = TEXT("");
-			FTetherSimulationModel::StaticStruct()->ExportText(Output, &Model, nullptr, nullptr, (PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited | PPF_IncludeTransient), nullptr);
-			UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s"), *Output);
+			Correction -= Directions[K] * Rhs[K];
 		}
+		Positions[K] += (InverseMass * ForceMultiplier) * Correction;
 	}
-
-	// Add simulation time, even for empty segments
-	for (FTetherProxySimulationSegmentSeries& Segment : SegmentsToSimulate)
-	{
-		Segment.AddSimulatedTime(SubstepTime);
-	}
-
 }
 
-void FTetherSimulation::VerletIntegrateSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float SubstepTime)
+/**
+ * Solves the constraints of a program on its chain of particles, with the solver chosen in the options
+ * Positions may be world space doubles or local space floats, the solvers don't depend on either
+ */
+template<bool bDebug, typename VectorType>
+static void SolveChain(FTetherSimulationSubstepContext& SubstepContext, const FTetherSimulationConstraintProgram& Program, VectorType* Positions, TArray<VectorType>& Directions, float ForceMultiplier)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::VerletIntegrateSegment"))
-
-	const FTetherSimulationParams& Params = SubstepContext.SimulationContext.Params;
-	
-	const int32 NumParticles = Segment.GetNumParticles();
-	const float SubstepTimeSqr = SubstepTime * SubstepTime;
+	FTetherSimulationContext& SimulationContext = SubstepContext.SimulationContext;
+	const FTetherSimulationParams& Params = SimulationContext.Params;
 
-	for (int32 ParticleIdx = 0; ParticleIdx < NumParticles; ParticleIdx++)
+	const bool bCompliantConstraints = Params.SimulationOptions.bEnableCompliance;
+	const int32 NumIterations = Params.SimulationOptions.StiffnessSolverIterations;
+	if (Params.SimulationOptions.ConstraintSolver == ETetherConstraintSolver::Coloured && !bCompliantConstraints)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Integrate Particle"))
-		
-		FTetherSimulationParticle& Particle = Segment.GetParticle(ParticleIdx);
-
-#ifdef TETHER_SIMULATION_DEBUG_CHECKS
-		ensure(!Particle.Position.ContainsNaN());
-#endif
-		
-		if (Particle.bFree)
+		SolveConstraintsColoured(Positions, Program, NumIterations, ForceMultiplier);
+	}
+	else if (Params.SimulationOptions.ConstraintSolver == ETetherConstraintSolver::Direct)
+	{
+		const float StretchCompliance = bCompliantConstraints ? Params.SimulationOptions.StretchCompliance / FMath::Max(SubstepContext.SubstepTime * SubstepContext.SubstepTime, SMALL_NUMBER) : 0.f;
+		SolveConstraintsDirect<bDebug>(SimulationContext, Positions, Directions, Program, StretchCompliance, ForceMultiplier);
+	}
+	else if (bCompliantConstraints)
+	{
+		// Compliant constraints accumulate their multipliers over the iterations of a single substep
+		const float SubstepTimeSqr = SubstepContext.SubstepTime * SubstepContext.SubstepTime;
+		ensure(SubstepTimeSqr > 0.f);
+		const float StretchCompliance = Params.SimulationOptions.StretchCompliance / SubstepTimeSqr;
+		const float StiffnessCompliance = Params.SimulationOptions.StiffnessCompliance / SubstepTimeSqr;
+		TArray<float>& Lambdas = SimulationContext.Scratch.ConstraintLambdas;
+		Lambdas.Reset();
+		Lambdas.SetNumZeroed(Program.Constraints.Num());
+
+		for (int32 IterationIdx = 0; IterationIdx < NumIterations; IterationIdx++)
 		{
-			// Calc overall force
-			const FVector ParticleForce = Params.CableForce;
-
-			// Find velocity
-			FVector Velocity = Particle.Position - Particle.OldPosition;
-
-			if(Params.SimulationOptions.Drag > 0.f)
-			{
-				const float Speed = Velocity.Size();
-				const FVector DragForce = -0.5f * Speed * Speed * Params.SimulationOptions.Drag * Velocity.GetSafeNormal();
-				Velocity += DragForce;
-			}
-			
-			// Update position
-			const FVector NewPosition = Particle.Position + Velocity + (SubstepTimeSqr * ParticleForce);
-
-			Particle.OldPosition = Particle.Position;
-			Particle.Position = NewPosition;
-
-			if(ParticleIdx > 0)
-			{
-				FTetherSimulationParticle& PreviousParticle = Segment.GetParticle(ParticleIdx - 1);
-				ensure(Particle.Position != PreviousParticle.Position);
-			}
+			SolveCompliantDistanceConstraints(Positions, Program.Constraints, 0, Program.NumStretchConstraints, StretchCompliance, Lambdas.GetData(), ForceMultiplier);
+			SolveCompliantDistanceConstraints(Positions, Program.Constraints, Program.NumStretchConstraints, Program.Constraints.Num(), StiffnessCompliance, Lambdas.GetData() + Program.NumStretchConstraints, ForceMultiplier);
+			SolveTetherConstraints(Positions, Program, ForceMultiplier);
 		}
+	}
+	else
+	{
+		// For each iteration, solve stretch constraints then stiffness constraints (distance constraints between every other particle) along the chain
+		for (int32 IterationIdx = 0; IterationIdx < NumIterations; IterationIdx++)
+		{
+			SolveDistanceConstraints<bDebug>(Positions, Program.Constraints, 0, Program.Constraints.Num(), ForceMultiplier);
 
-#ifdef TETHER_SIMULATION_DEBUG_CHECKS
-		ensure(!Particle.Position.ContainsNaN());
-#endif
+			// Enforce maximum stretch along the whole cable at once, rather than waiting for corrections to propagate one particle per iteration
+			SolveTetherConstraints(Positions, Program, ForceMultiplier);
+		}
 	}
 }
 
-static void SolveDistanceConstraint(FTetherSimulationParticle& ParticleA, FTetherSimulationParticle& ParticleB, float DesiredDistance, float ForceMultiplier)
+template<uint32 Features>
+void FTetherSimulation::SolveConstraintsForSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float ForceMultiplier)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SolveDistanceConstraint"))
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SolveConstraintsForSegment"));
 
-	ensure(DesiredDistance > KINDA_SMALL_NUMBER);
+	constexpr bool bDebug = (Features & SubstepFeature_Debug) != 0;
+
+	FTetherSimulationContext& SimulationContext = SubstepContext.SimulationContext;
+	const FTetherSimulationParams& Params = SimulationContext.Params;
+	FTetherSimulationParticleStore& ParticleStore = SimulationContext.ParticleStore;
+	check(Segment.ParticleStore == &ParticleStore);
+	if (!ensure(Segment.HasConstraintProgram()))
+	{
+		return;
+	}
 
-	if(ParticleA.ParticleUniqueId == CVarDebugParticle.GetValueOnAnyThread())
+	// Solve on a copy of the chain of particles the program was compiled for, including the synthetic tangent particles
+	FTetherSimulationConstraintProgram& Program = Segment.GetConstraintProgram();
+	Program.UpdateInverseMasses(ParticleStore);
+	FTetherSimulationScratch& Scratch = SimulationContext.Scratch;
+	if (Params.SimulationOptions.bEnableLocalSpaceSolver)
 	{
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, before solve constraint (A): %s"), *GetDebugParticleString(ParticleA));
+		Program.GatherLocalPositions(ParticleStore, Scratch.LocalChainPositions);
+		SolveChain<bDebug>(SubstepContext, Program, Scratch.LocalChainPositions.GetData(), Scratch.LocalChainConstraintDirections, ForceMultiplier);
+		Program.ScatterLocalPositions(Scratch.LocalChainPositions, ParticleStore);
 	}
-	else if (ParticleB.ParticleUniqueId == CVarDebugParticle.GetValueOnAnyThread())
+	else
 	{
-		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("Debug Particle, before solve constraint (B): %s"), *GetDebugParticleString(ParticleB));
+		Program.GatherPositions(ParticleStore, Scratch.ChainPositions);
+		SolveChain<bDebug>(SubstepContext, Program, Scratch.ChainPositions.GetData(), Scratch.ChainConstraintDirections, ForceMultiplier);
+		Program.ScatterPositions(Scratch.ChainPositions, ParticleStore);
 	}
-	
-	ensure(ParticleA.Position != ParticleB.Position);
-	
-	// Find current vector between particles
-	const FVector Delta = ParticleB.Position - ParticleA.Position;
+}
 
-	const float CurrentDistance = Delta.Size();
+/**
+ * Overlaps the bounds of everything the free particles of the series may sweep through this substep, and resolves the overlaps to the bodies to sweep against
+ * Candidates are sorted so that hits are gathered in the same order every time
+ */
+void GatherCollisionCandidates(FTetherSimulationSubstepContext& SubstepContext, const FTetherProxySimulationSegmentSeries& Series, UWorld* World, float CollisionRadius, ECollisionChannel TraceChannel, const FCollisionResponseParams& ResponseParams)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Gather Collision Candidates"));
 
-	ensure(CurrentDistance < BIG_NUMBER);
-	
-	const float ErrorFactor = (CurrentDistance - DesiredDistance) / CurrentDistance;
-	
-	ensure(ErrorFactor != 1);
+	const FTetherSimulationParams& Params = SubstepContext.SimulationContext.Params;
+	const FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	FTetherSimulationScratch& Scratch = SubstepContext.SimulationContext.Scratch;
+	Scratch.CollisionOverlaps.Reset();
+	Scratch.CollisionCandidates.Reset();
 
-	// Only move free particles to satisfy constraints
-	if (ParticleA.bFree && ParticleB.bFree)
+	FBox SweepBounds(ForceInit);
+	for(int32 i = Series.ParticleStoreOffset; i < Series.ParticleStoreOffset + Series.ParticleStoreNum; i++)
 	{
-		ParticleA.Position += ErrorFactor * 0.5f * Delta * ForceMultiplier;
-		ParticleB.Position -= ErrorFactor * 0.5f * Delta * ForceMultiplier;
+		if(ParticleStore.IsFree(i))
+		{
+			SweepBounds += ParticleStore.OldPositions[i];
+			SweepBounds += ParticleStore.Positions[i];
+		}
 	}
-	else if (ParticleA.bFree)
+	if(!SweepBounds.IsValid)
 	{
-		ParticleA.Position += ErrorFactor * Delta * ForceMultiplier;
+		return;
 	}
-	else if (ParticleB.bFree)
+
+	World->OverlapMultiByChannel(Scratch.CollisionOverlaps, SweepBounds.GetCenter(), FQuat::Identity, TraceChannel, FCollisionShape::MakeBox(SweepBounds.GetExtent() + FVector(CollisionRadius)), Params.CollisionQueryParams, ResponseParams);
+
+	const UPrimitiveComponent* OwnComponent = Params.Component.IsValid(false, true) ? Params.Component.Get() : nullptr;
+	for(const FOverlapResult& Overlap : Scratch.CollisionOverlaps)
 	{
-		ParticleB.Position -= ErrorFactor * Delta * ForceMultiplier;
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		const AActor* Actor = Overlap.GetActor();
+		if(!IsValid(Component) || (IsValid(Actor) && Actor->IsA<ATriggerBase>()))
+		{
+			continue;
+		}
+
+		// Self-collision bodies aren't owned by the component, but are indexed by particle
+		FBodyInstance* BodyInstance;
+		if(Component == OwnComponent)
+		{
+			BodyInstance = Params.BodyInstances.IsValidIndex(Overlap.ItemIndex) ? Params.BodyInstances[Overlap.ItemIndex] : nullptr;
+		}
+		else
+		{
+			BodyInstance = Component->GetBodyInstance(NAME_None, true, Overlap.ItemIndex);
+		}
+		if(!BodyInstance || !BodyInstance->IsValidBodyInstance())
+		{
+			continue;
+		}
+
+		FTetherSimulationCollisionCandidate& Candidate = Scratch.CollisionCandidates.AddDefaulted_GetRef();
+		Candidate.BodyInstance = BodyInstance;
+		Candidate.Component = Component;
+		Candidate.Actor = Overlap.GetActor();
+		Candidate.Item = Overlap.ItemIndex;
+		Candidate.Bounds = BodyInstance->GetBodyBounds().ExpandBy(CollisionRadius);
 	}
 
-	ensure(ParticleA.Position != ParticleB.Position);
+	Algo::Sort(Scratch.CollisionCandidates, [](const FTetherSimulationCollisionCandidate& A, const FTetherSimulationCollisionCandidate& B)
+	{
+		const uint32 IdA = A.Component.Get()->GetUniqueID();
+		const uint32 IdB = B.Component.Get()->GetUniqueID();
+		return IdA < IdB || (IdA == IdB && A.Item < B.Item);
+	});
+	Scratch.CollisionCandidates.SetNum(Algo::Unique(Scratch.CollisionCandidates, [](const FTetherSimulationCollisionCandidate& A, const FTetherSimulationCollisionCandidate& B)
+	{
+		return A.BodyInstance == B.BodyInstance;
+	}));
+}
 
-#ifdef TETHER_SIMULATION_DEBUG_CHECKS
+/** Sweeps a sphere against each gathered candidate whose bounds the sweep touches, adding a hit for each body hit */
+bool SweepCollisionCandidates(TArrayView<const FTetherSimulationCollisionCandidate> Candidates, TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, const FCollisionShape& CollisionShape, bool bTraceComplex)
+{
+	FBox SweepBounds(Start, Start);
+	SweepBounds += End;
+
+	for(const FTetherSimulationCollisionCandidate& Candidate : Candidates)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Check NaN"))
-		ensure(!ParticleA.Position.ContainsNaN());
-		ensure(!ParticleB.Position.ContainsNaN());
-	}
+		if(!Candidate.Bounds.Intersect(SweepBounds))
+		{
+			continue;
+		}
+
+		FHitResult Hit;
+		if(Candidate.BodyInstance->Sweep(Hit, Start, End, FQuat::Identity, CollisionShape, bTraceComplex))
+		{
+			Hit.bBlockingHit = true;
+			Hit.Component = Candidate.Component;
+			Hit.Item = Candidate.Item;
+#if UE_VERSION_OLDER_THAN(5,0,0)
+			Hit.Actor = Candidate.Actor;
+#else
+			Hit.HitObjectHandle = FActorInstanceHandle(Candidate.Actor.Get());
 #endif
+			OutHits.Add(Hit);
+		}
+	}
+	return OutHits.Num() > 0;
 }
 
-FTetherSimulationParticle& GetParticle(FTetherProxySimulationSegmentSeries& Segment, bool bSynthStart, FTetherSimulationParticle& SynthStartParticle, bool bSynthEnd, FTetherSimulationParticle& SynthEndParticle, int32 ParticleIndex)
+// Substeps to wait before measuring the clearance of a particle again after it was found not to be clear, as the measurement costs about as much as a sweep
+static constexpr int32 CollisionClearanceRetrySubsteps = 8;
+
+/** Measures how far a particle can move from its position before its collision sphere could touch anything, up to the culling distance */
+float MeasureCollisionClearance(const FTetherSimulationParams& Params, const FTetherCollisionSnapshot* CollisionSnapshot, UWorld* World, const FVector& Position, float CollisionRadius, ECollisionChannel TraceChannel, const FCollisionResponseParams& ResponseParams)
 {
-	const int32 TransformedIndex = bSynthStart ? ParticleIndex - 1 : ParticleIndex;
-	
-	if(TransformedIndex == -1)
+	const float CullingDistance = Params.SimulationOptions.CollisionCullingDistance;
+	const float MaxDistance = CollisionRadius + CullingDistance;
+
+	// The snapshot can measure the actual distance, which lets the particle use whatever clearance it has
+	if(CollisionSnapshot && CollisionSnapshot->Contains(Position, Position, MaxDistance))
 	{
-		return SynthStartParticle;
+		return CollisionSnapshot->GetDistanceToNearest(Position, MaxDistance) - CollisionRadius;
 	}
-	if(TransformedIndex > Segment.GetNumParticles() - 1)
+
+	// The physics scene can only tell whether anything is within the whole distance
+	if(World && !World->OverlapBlockingTestByChannel(Position, FQuat::Identity, TraceChannel, FCollisionShape::MakeSphere(MaxDistance), Params.CollisionQueryParams, ResponseParams))
 	{
-		ensure(bSynthEnd);
-		return SynthEndParticle;
+		return CullingDistance;
 	}
-
-	return Segment.GetParticle(TransformedIndex);
+	return 0.f;
 }
 
-void FTetherSimulation::SolveConstraintsForSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float ForceMultiplier)
+/** If the particle is still within the margin of where its contact was cached, so the contact can be trusted */
+bool IsNearCachedContact(const FTetherSimulationParticleStore& ParticleStore, int32 ParticleCableIndex, float CollisionRadius, float Margin)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::SolveConstraintsForSegment"));
-
-	const FTetherSimulationParams& Params = SubstepContext.SimulationContext.Params;
-
-	const int32 StartPointUniqueId =  Segment.GetSegmentConst(0)->SegmentUniqueId;
-	const int32 EndPointUniqueId = Segment.GetLastSegmentConst()->SegmentUniqueId + 1;
-	
-	const bool bFixedStartTangent = Params.SegmentParams.IsValidIndex(StartPointUniqueId) && Params.SegmentParams[StartPointUniqueId].SimulationOptions.ShouldUseSplineTangents();
-	const bool bFixedEndTangent = Params.SegmentParams.IsValidIndex(EndPointUniqueId) && Params.SegmentParams[EndPointUniqueId].SimulationOptions.ShouldUseSplineTangents();
-	
-	const int32 NumParticleSegments = Segment.GetNumParticleSegments() + bFixedStartTangent + bFixedEndTangent;
-	const float ParticleSegmentLength = Segment.GetParticleSegmentLength();
-	ensure(ParticleSegmentLength > 0);
+	const FPlane& Plane = ParticleStore.ContactPlanes[ParticleCableIndex];
+	const FVector Normal = Plane.GetNormal();
+	const FVector& End = ParticleStore.Positions[ParticleCableIndex];
+	const FVector Offset = End - ParticleStore.ContactAnchors[ParticleCableIndex];
+	const FVector SlideOffset = Offset - (Offset | Normal) * Normal;
+	return SlideOffset.SizeSquared() < FMath::Square(Margin) && Plane.PlaneDot(End) < CollisionRadius + Margin;
+}
 
-	FTetherSimulationParticle SynthStartParticle;
-	if(bFixedStartTangent)
+/**
+ * Collides the particle's sweep with the plane of its cached contact, as a sweep against the surface would
+ * @return	False if the particle ended up clear of the plane
+ */
+bool GetCachedContactHit(const FTetherSimulationParticleStore& ParticleStore, int32 ParticleCableIndex, float CollisionRadius, FHitResult& OutHit)
+{
+	const FPlane& Plane = ParticleStore.ContactPlanes[ParticleCableIndex];
+	const FVector Normal = Plane.GetNormal();
+	const FVector& Start = ParticleStore.OldPositions[ParticleCableIndex];
+	const FVector& End = ParticleStore.Positions[ParticleCableIndex];
+	const float StartDistance = Plane.PlaneDot(Start);
+	const float EndDistance = Plane.PlaneDot(End);
+	if(EndDistance >= CollisionRadius)
 	{
-		FTetherSimulationParticle& First = Segment.GetParticle(0);
-		const FVector Tangent = Segment.GetSplineSegmentInfo().StartLeaveTangent;
-		ensure(!Tangent.IsZero());
-		const FVector Position = First.Position - (Tangent.GetSafeNormal() * ParticleSegmentLength);
-		ensure(Position != First.Position);
-		SynthStartParticle = FTetherSimulationParticle(false, Position);
+		return false;
 	}
-	
-	FTetherSimulationParticle SynthEndParticle;
-	if(bFixedEndTangent)
+
+	OutHit = FHitResult(Start, End);
+	OutHit.bBlockingHit = true;
+	OutHit.Normal = Normal;
+	OutHit.ImpactNormal = Normal;
+	OutHit.Component = ParticleStore.ContactComponents[ParticleCableIndex];
+	if(StartDistance <= CollisionRadius)
 	{
-		FTetherSimulationParticle& Last = Segment.GetParticle(Segment.GetNumParticles() - 1);
-		const FVector Tangent = Segment.GetSplineSegmentInfo().EndArriveTangent;
-		ensure(!Tangent.IsZero());
-		const FVector Position = Last.Position - (Tangent.GetSafeNormal() * -1.f * ParticleSegmentLength);
-		ensure(Position != Last.Position);
-		SynthEndParticle = FTetherSimulationParticle(false, Position);
+		// Already touching at the start, so push the end back out onto the surface
+		OutHit.bStartPenetrating = true;
+		OutHit.PenetrationDepth = CollisionRadius - EndDistance;
+		OutHit.Time = 0.f;
+		OutHit.Location = End;
 	}
-	
-	// For each iteration..
-	for (int32 IterationIdx = 0; IterationIdx < Params.SimulationOptions.StiffnessSolverIterations; IterationIdx++)
+	else
 	{
-		// Solve distance constraint for each segment
-		for (int32 SegIdx = 0; SegIdx < NumParticleSegments; SegIdx++)
-		{
-			FTetherSimulationParticle& ParticleA = GetParticle(Segment, bFixedStartTangent, SynthStartParticle, bFixedEndTangent, SynthEndParticle, SegIdx);
-			FTetherSimulationParticle& ParticleB = GetParticle(Segment, bFixedStartTangent, SynthStartParticle, bFixedEndTangent, SynthEndParticle, SegIdx + 1);
-			// Solve for this pair of particles
-			SolveDistanceConstraint(ParticleA, ParticleB, ParticleSegmentLength, ForceMultiplier);
-		}
-
-		// If desired, solve stiffness constraints (distance constraints between every other particle)
-		if (Params.SimulationOptions.bEnableStiffness)
-		{
-			for (int32 SegIdx = 0; SegIdx < NumParticleSegments - 1; SegIdx++)
-			{
-				FTetherSimulationParticle& ParticleA = GetParticle(Segment, bFixedStartTangent, SynthStartParticle, bFixedEndTangent, SynthEndParticle, SegIdx);
-				FTetherSimulationParticle& ParticleB = GetParticle(Segment, bFixedStartTangent, SynthStartParticle, bFixedEndTangent, SynthEndParticle, SegIdx + 2);
-				SolveDistanceConstraint(ParticleA, ParticleB, 2.f * ParticleSegmentLength, ForceMultiplier);
-			}
-		}
+		OutHit.Time = (StartDistance - CollisionRadius) / (StartDistance - EndDistance);
+		OutHit.Location = FMath::Lerp(Start, End, OutHit.Time);
 	}
+	OutHit.ImpactPoint = OutHit.Location - Normal * (OutHit.bStartPenetrating ? EndDistance : CollisionRadius);
+	OutHit.Distance = OutHit.Time * FVector::Dist(Start, End);
+	return true;
 }
 
-FHitResult* GetBestHit(const ::FTetherSimulationSubstepContext& SubstepContext, const ::FTetherSimulationParticle& SimulatingParticle, TArray<FHitResult>& Hits, int32 ParticleCableIndex, TWeakObjectPtr<UPrimitiveComponent> Component)
+FHitResult* GetBestHit(const ::FTetherSimulationSubstepContext& SubstepContext, int32 ParticleCableIndex, TArray<FHitResult>& Hits, TWeakObjectPtr<UPrimitiveComponent> Component)
 {
-	const FVector& ParticleStartPos = SimulatingParticle.OldPosition;
+	// Particle store indices are the particle indices of the entire cable
+	const FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	const FVector& ParticleStartPos = ParticleStore.OldPositions[ParticleCableIndex];
 	FHitResult* ClosestHit = nullptr;
 	float ClosestDistSquared = BIG_NUMBER;
 	for(FHitResult& Hit : Hits)
@@ -474,8 +2273,8 @@ FHitResult* GetBestHit(const ::FTetherSimulationSubstepContext& SubstepContext,
 				continue;
 			}
 
-			const uint32 OtherParticleSegmentIndex = SubstepContext.SimulationContext.Model.GetSegmentWithParticle(Hit.Item)->SegmentUniqueId;
-			if(OtherParticleSegmentIndex > SubstepContext.SimulationContext.Model.GetSegmentWithParticle(SimulatingParticle.ParticleUniqueId, true)->SegmentUniqueId)
+			const int32 OtherParticleSegmentIndex = ParticleStore.FindSegmentWithParticle(Hit.Item);
+			if(OtherParticleSegmentIndex > ParticleStore.FindSegmentWithParticle(ParticleCableIndex))
 			{
 				// Hit other particle in a future segment, ignore
 				continue;
@@ -519,13 +2318,14 @@ void TruncHit(FHitResult& Hit)
 	}
 }
 
-void ResolveHit(FTetherSimulationSubstepContext& SubstepContext, FTetherSimulationParticle& Particle, FHitResult& HitResult, float CollisionFriction, float ForceMultiplier)
+void ResolveHit(FTetherSimulationSubstepContext& SubstepContext, int32 ParticleIndex, FHitResult& HitResult, float CollisionFriction, float ForceMultiplier)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Resolve Particle Collision Hit"));
 
 	const FTetherSimulationParams& Params = SubstepContext.SimulationContext.Params;
 	FTetherSimulationResultInfo& ResultInfo = SubstepContext.SimulationContext.ResultInfo;
-	FTetherSimulationModel& Model = SubstepContext.SimulationContext.Model;
+	FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	const FTetherSimulationParticleRef Particle = ParticleStore.GetParticleRef(ParticleIndex);
 	
 	ResultInfo.HitComponents.AddUnique(HitResult.Component);
 	ResultInfo.NumCollisionHits++;
@@ -547,11 +2347,11 @@ void ResolveHit(FTetherSimulationSubstepContext& SubstepContext, FTetherSimulati
 	const bool bIsSelfCollision = HitResult.Component.IsValid(false, true) && Params.Component.IsValid(false, true) && HitResult.Component.Get() == Params.Component.Get();
 	if(bIsSelfCollision)
 	{
-		check(HitResult.Item >= 0);
-		const int32 ThisParticleSegmentIndex = Model.GetSegmentWithParticle(Particle.ParticleUniqueId, true)->SegmentUniqueId;
+		check(ParticleStore.IsValidIndex(HitResult.Item));
+		const int32 ThisParticleSegmentIndex = ParticleStore.FindSegmentWithParticle(ParticleIndex);
 		
-		FTetherSimulationParticle& OtherParticle = Model.GetParticle(HitResult.Item);
-		const int32 OtherParticleSegmentIndex = Model.GetSegmentWithParticle(HitResult.Item)->SegmentUniqueId;
+		const FTetherSimulationParticleRef OtherParticle = ParticleStore.GetParticleRef(HitResult.Item);
+		const int32 OtherParticleSegmentIndex = ParticleStore.FindSegmentWithParticle(HitResult.Item);
 
 		if(ThisParticleSegmentIndex == OtherParticleSegmentIndex)
 		{
@@ -626,25 +2426,34 @@ void ResolveHit(FTetherSimulationSubstepContext& SubstepContext, FTetherSimulati
 
 }
 
+template<uint32 Features>
 void FTetherSimulation::PerformCollision(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& SimulatingSegmentSeries, float ForceMultiplier)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulation::PerformCollision"));
 
-	FTetherSimulationModel& Model = SubstepContext.SimulationContext.Model;
+	constexpr bool bDebug = (Features & SubstepFeature_Debug) != 0;
+
 	const FTetherSimulationParams& Params = SubstepContext.SimulationContext.Params;
-	
-	if(!Params.World.IsValid(false, true))
+	FTetherSimulationParticleStore& ParticleStore = SubstepContext.SimulationContext.ParticleStore;
+	check(SimulatingSegmentSeries.ParticleStore == &ParticleStore);
+
+	const FTetherCollisionSnapshot* CollisionSnapshot = Params.CollisionSnapshot.Get();
+	UWorld* World = Params.World.IsValid(false, true) ? Params.World.Get() : nullptr;
+	if(!World && !CollisionSnapshot)
 	{
 		return;
 	}
-	UWorld* World = Params.World.Get();
 
-	UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: PhysicsSceneHash: %i"), *Params.SimulationName, SubstepContext.SubstepNum, FTetherPhysicsUtils::HashPhyiscsBodies(World));
+	const FTetherCollisionDistanceField* DistanceField = CollisionSnapshot && Params.SimulationOptions.ShouldUseDistanceField() && CollisionSnapshot->GetDistanceField().IsValid() ? &CollisionSnapshot->GetDistanceField() : nullptr;
+	const bool bSweepOutsideDistanceField = DistanceField && CollisionSnapshot->HasSweptComponents();
 
-	const bool bDetailedSubstepDebug = CVarDebugSubstep.GetValueOnAnyThread() == SubstepContext.SubstepNum;
-	const int32 DetailedDebugParticle = CVarDebugParticle.GetValueOnAnyThread();
+	if (bDebug && World)
+	{
+		UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: PhysicsSceneHash: %i"), *Params.SimulationName, SubstepContext.SubstepNum, FTetherPhysicsUtils::HashPhyiscsBodies(World));
+	}
 
-	const int32 StartingParticleCableIndex = Model.GetStartingParticleIndexForSegment(SimulatingSegmentSeries.GetFirstSegmentUniqueId());
+	const bool bDetailedSubstepDebug = bDebug && CVarDebugSubstep.GetValueOnAnyThread() == SubstepContext.SubstepNum;
+	const int32 DetailedDebugParticle = bDebug ? CVarDebugParticle.GetValueOnAnyThread() : INDEX_NONE;
 
 	float CableWidth = Params.CollisionWidth;
 	float CollisionFriction = Params.SimulationOptions.CollisionFriction;
@@ -657,35 +2466,149 @@ void FTetherSimulation::PerformCollision(FTetherSimulationSubstepContext& Subste
 	FCollisionResponseParams ResponseParams = FCollisionResponseParams();
 	UCollisionProfile::GetChannelAndResponseParams(TraceProfile.Name, TraceChannel, ResponseParams);
 
-	FCollisionShape CollisionShape = FCollisionShape::MakeSphere(0.5f * CableWidth);
+	const float CollisionRadius = 0.5f * CableWidth;
+	FCollisionShape CollisionShape = FCollisionShape::MakeSphere(CollisionRadius);
 
-	const int32 NumParticles = SimulatingSegmentSeries.GetNumParticles();
+	const int32 NumParticles = SimulatingSegmentSeries.ParticleStoreNum;
+	const bool bSkipInactiveParticles = Params.SimulationOptions.bEnableParticleSleeping;
 
-	// Iterate over each particle
-	for (int32 ParticleIdx = 0; ParticleIdx < NumParticles; ParticleIdx++)
+	// Query the physics scene once for the whole series, and narrow each particle's sweep down to the bodies found
+	const bool bBatchedQueries = World && Params.SimulationOptions.bEnableBatchedCollisionQueries;
+	if(bBatchedQueries)
+	{
+		GatherCollisionCandidates(SubstepContext, SimulatingSegmentSeries, World, CollisionRadius, TraceChannel, ResponseParams);
+	}
+	const TArrayView<const FTetherSimulationCollisionCandidate> CollisionCandidates = SubstepContext.SimulationContext.Scratch.CollisionCandidates;
+
+	const bool bCollisionCulling = Params.SimulationOptions.ShouldUseCollisionCulling();
+	const bool bContactCaching = Params.SimulationOptions.ShouldUseContactCaching();
+	const float ContactCacheMargin = Params.SimulationOptions.ContactCacheMargin;
+	FTetherSimulationResultInfo& ResultInfo = SubstepContext.SimulationContext.ResultInfo;
+
+	auto CollideParticle = [&](int32 ParticleIdx)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Perform Particle Collision"))
-		FTetherSimulationParticle& Particle = SimulatingSegmentSeries.GetParticle(ParticleIdx);
+		const int32 ParticleCableIndex = SimulatingSegmentSeries.ParticleStoreOffset + ParticleIdx;
+		if (bSkipInactiveParticles && !ParticleStore.IsFree(ParticleCableIndex))
+		{
+			// Fixed or sleeping particles don't need to sweep
+			return;
+		}
+
+		const FTetherSimulationParticleRef Particle = ParticleStore.GetParticleRef(ParticleCableIndex);
 		// If particle is free
 		if (Particle.bFree)
 		{
-			const int32 ParticleCableIndex = StartingParticleCableIndex + ParticleIdx;
-			
-			// Do sphere sweep
-			TArray<FHitResult> Result;
+			// Set once the distance field has handled the copied collision, leaving only the bodies it couldn't copy to sweep
+			bool bSweepOnlySweptComponents = false;
+
+			// Push the particle out of the distance field with a lookup at where it ended up
+			// Distances to triangles are unsigned, so only particles that moved less than their radius can use the field, as anything further could have passed through a surface
+			if(DistanceField
+				&& FVector::DistSquared(Particle.OldPosition, Particle.Position) <= FMath::Square(CollisionRadius)
+				&& CollisionSnapshot->Contains(Particle.OldPosition, Particle.Position, CollisionRadius))
+			{
+				float Distance;
+				FVector Normal;
+				int32 BodyIndex;
+				const bool bNearCollision = DistanceField->Sample(Particle.Position, Distance, Normal, BodyIndex);
+
+				// Particles whose start and end fall on opposite sides of a surface crossed it during the substep, and fall through to the sweep instead
+				float StartDistance;
+				FVector StartNormal;
+				int32 StartBodyIndex;
+				const bool bCrossedSurface = bNearCollision
+					&& DistanceField->Sample(Particle.OldPosition, StartDistance, StartNormal, StartBodyIndex)
+					&& (StartNormal | Normal) < 0.f;
+
+				if(!bCrossedSurface)
+				{
+					if(bNearCollision && Distance < CollisionRadius)
+					{
+						FHitResult Hit;
+						Hit.bBlockingHit = true;
+						Hit.bStartPenetrating = true;
+						Hit.Normal = Normal;
+						Hit.ImpactNormal = Normal;
+						Hit.PenetrationDepth = CollisionRadius - Distance;
+						Hit.Location = Particle.Position;
+						Hit.ImpactPoint = Particle.Position - Normal * Distance;
+						Hit.TraceStart = Particle.OldPosition;
+						Hit.TraceEnd = Particle.Position;
+						Hit.Component = CollisionSnapshot->GetBodyComponent(BodyIndex);
+						ResolveHit(SubstepContext, ParticleCableIndex, Hit, CollisionFriction, ForceMultiplier);
+					}
+					if(!bSweepOutsideDistanceField)
+					{
+						return;
+					}
+					bSweepOnlySweptComponents = true;
+				}
+			}
+
+			// Particles staying close to where they last hit something and still pressing into that surface collide with its plane instead of sweeping
+			// Particles that come clear of the plane sweep as usual, as they may be touching other surfaces within the margin
+			if(bContactCaching && ParticleStore.HasCachedContact(ParticleCableIndex))
+			{
+				FHitResult CachedHit;
+				if(!IsNearCachedContact(ParticleStore, ParticleCableIndex, CollisionRadius, ContactCacheMargin))
+				{
+					ParticleStore.ContactPlanes[ParticleCableIndex] = FPlane(ForceInit);
+				}
+				else if(GetCachedContactHit(ParticleStore, ParticleCableIndex, CollisionRadius, CachedHit))
+				{
+					ResultInfo.NumCachedContactHits++;
+					ResolveHit(SubstepContext, ParticleCableIndex, CachedHit, CollisionFriction, ForceMultiplier);
+					return;
+				}
+			}
+
+			// A sphere swept between two points within the clear radius of the particle can't touch anything
+			if(bCollisionCulling)
+			{
+				const float ClearRadiusSquared = FMath::Square(ParticleStore.ClearRadii[ParticleCableIndex]);
+				const FVector& ClearCentre = ParticleStore.ClearCentres[ParticleCableIndex];
+				if(FVector::DistSquared(Particle.OldPosition, ClearCentre) < ClearRadiusSquared && FVector::DistSquared(Particle.Position, ClearCentre) < ClearRadiusSquared)
+				{
+					ResultInfo.NumCulledCollisionSweeps++;
+					return;
+				}
+			}
+			ResultInfo.NumCollisionSweeps++;
+
+			// Do sphere sweep, reusing the hits array of the simulation
+			TArray<FHitResult>& Result = SubstepContext.SimulationContext.Scratch.CollisionHits;
+			Result.Reset();
 
 			// Note: Sweep single in PhysX does not appear to be deterministic. If the swept shape is intersecting multiple bodies at the start of the simulation, it seems that the hit result that is returned is random
 			// So we do a sweep multi and manually choose the result deterministically
-			bool bHit = World->SweepMultiByChannel(Result, Particle.OldPosition, Particle.Position, FQuat::Identity, TraceChannel, CollisionShape, QueryParams, ResponseParams);
+			// Sweeps within the collision snapshot don't need to touch the physics scene at all
+			bool bHit;
+			bool bResolvedHit = false;
+			if(bSweepOnlySweptComponents)
+			{
+				bHit = CollisionSnapshot->SweepSweptComponents(Result, Particle.OldPosition, Particle.Position, CollisionRadius);
+			}
+			else if(CollisionSnapshot && CollisionSnapshot->Contains(Particle.OldPosition, Particle.Position, CollisionRadius))
+			{
+				bHit = CollisionSnapshot->SweepSphere(Result, Particle.OldPosition, Particle.Position, CollisionRadius);
+			}
+			else if(bBatchedQueries)
+			{
+				bHit = SweepCollisionCandidates(CollisionCandidates, Result, Particle.OldPosition, Particle.Position, CollisionShape, QueryParams.bTraceComplex);
+			}
+			else
+			{
+				bHit = World && World->SweepMultiByChannel(Result, Particle.OldPosition, Particle.Position, FQuat::Identity, TraceChannel, CollisionShape, QueryParams, ResponseParams);
+			}
 			// If we got a hit, resolve it
 			if (bHit)
 			{
-				FHitResult* Hit = GetBestHit(SubstepContext, Particle, Result, ParticleCableIndex, Params.Component);
+				FHitResult* Hit = GetBestHit(SubstepContext, ParticleCableIndex, Result, Params.Component);
 				if(Hit)
 				{
 					TruncHit(*Hit);
 				}
-				if(bDetailedSubstepDebug || DetailedDebugParticle == Particle.ParticleUniqueId)
+				if(bDebug && (bDetailedSubstepDebug || DetailedDebugParticle == Particle.ParticleUniqueId))
 				{
 					// Detailed logging
 					UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Substep %i: Particle %i: ParticleUniqueId %i"), *Params.SimulationName, SubstepContext.SubstepNum, ParticleIdx, Particle.ParticleUniqueId);
@@ -713,21 +2636,65 @@ void FTetherSimulation::PerformCollision(FTetherSimulationSubstepContext& Subste
 
 				if(Hit)
 				{
-					ResolveHit(SubstepContext, Particle, *Hit, CollisionFriction, ForceMultiplier);
+					// Cache the surface as the plane touched by the particle once fully pushed out of it
+					if(bContactCaching && !Hit->Normal.IsNearlyZero())
+					{
+						const FVector ContactNormal = Hit->Normal.GetSafeNormal();
+						const FVector ContactPosition = Hit->bStartPenetrating ? Particle.Position + ContactNormal * Hit->PenetrationDepth : Hit->Location;
+						ParticleStore.ContactPlanes[ParticleCableIndex] = FPlane(ContactPosition - ContactNormal * CollisionRadius, ContactNormal);
+						ParticleStore.ContactAnchors[ParticleCableIndex] = ContactPosition;
+						ParticleStore.ContactComponents[ParticleCableIndex] = Hit->Component;
+					}
+
+					ResolveHit(SubstepContext, ParticleCableIndex, *Hit, CollisionFriction, ForceMultiplier);
+					bResolvedHit = true;
 				}
 
 				if (bDetailedSubstepDebug)
 				{
-					FString Output = TEXT("");
-					FTetherSimulationParticle::StaticStruct()->ExportText(Output, &Particle, nullptr, nullptr, (PPF_ExportsNotFullyQualified | PPF_Copy | PPF_Delimited | PPF_IncludeTransient), nullptr);
-					UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Particle: %s"), *Params.SimulationName, *Output);
+					UE_LOG(LogTetherSimulation, VeryVerbose, TEXT("%s: Particle: %s"), *Params.SimulationName, *GetDebugParticleString(Particle));
 				}
 
 			}
+
+			// Particles in contact keep sweeping, while those that are clear occasionally measure how far they can move before sweeping again
+			if(bCollisionCulling)
+			{
+				float& ClearRadius = ParticleStore.ClearRadii[ParticleCableIndex];
+				int32& NextClearanceSubstep = ParticleStore.NextClearanceSubsteps[ParticleCableIndex];
+				ClearRadius = 0.f;
+				if(bResolvedHit)
+				{
+					NextClearanceSubstep = SubstepContext.SubstepNum + CollisionClearanceRetrySubsteps;
+				}
+				else if(SubstepContext.SubstepNum >= NextClearanceSubstep)
+				{
+					ParticleStore.ClearCentres[ParticleCableIndex] = Particle.Position;
+					ClearRadius = MeasureCollisionClearance(Params, CollisionSnapshot, World, Particle.Position, CollisionRadius, TraceChannel, ResponseParams);
+					if(ClearRadius <= 0.f)
+					{
+						NextClearanceSubstep = SubstepContext.SubstepNum + CollisionClearanceRetrySubsteps;
+					}
+				}
+			}
 		}
 #ifdef TETHER_SIMULATION_DEBUG_CHECKS
 		ensure(!Particle.Position.ContainsNaN());
 #endif
+	};
+
+	// Iterate over each particle
+	for (int32 ParticleIdx = 0; ParticleIdx < NumParticles; ParticleIdx++)
+	{
+		if (bDebug)
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Perform Particle Collision"))
+			CollideParticle(ParticleIdx);
+		}
+		else
+		{
+			CollideParticle(ParticleIdx);
+		}
 	}
 
 }
@@ -0,0 +1,245 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#include "Simulation/TetherSimulationConstraintProgram.h"
+#include "Simulation/TetherSimulationParticleStore.h"
+
+void FTetherSimulationConstraintList::Reset()
+{
+	IndicesA.Reset();
+	IndicesB.Reset();
+	RestLengths.Reset();
+	InverseMassesA.Reset();
+	InverseMassesB.Reset();
+}
+
+void FTetherSimulationConstraintList::Add(int32 IndexA, int32 IndexB, float RestLength)
+{
+	IndicesA.Add(IndexA);
+	IndicesB.Add(IndexB);
+	RestLengths.Add(RestLength);
+	InverseMassesA.Add(0.f);
+	InverseMassesB.Add(0.f);
+}
+
+void FTetherSimulationConstraintList::UpdateInverseMasses(const TArray<float>& ChainInverseMasses)
+{
+	for(int32 i = 0; i < Num(); i++)
+	{
+		InverseMassesA[i] = ChainInverseMasses[IndicesA[i]];
+		InverseMassesB[i] = ChainInverseMasses[IndicesB[i]];
+	}
+}
+
+void FTetherSimulationConstraintProgram::Build(const FTetherSimulationParticleStore& ParticleStore, int32 InParticleStoreOffset, int32 InParticleStoreNum, float ParticleSegmentLength, bool bEnableStiffness, const FVector* StartTangent, const FVector* EndTangent, const TArray<int32>* AnchorIndices)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulationConstraintProgram::Build"))
+
+	ParticleStoreOffset = InParticleStoreOffset;
+	ParticleStoreNum = InParticleStoreNum;
+	ChainInverseMasses.Reset();
+	Constraints.Reset();
+	NumStretchConstraints = 0;
+	ColouredConstraints.Reset();
+	ColourOffsets.Reset();
+	TetherParticles.Reset();
+	TetherAnchors.Reset();
+	TetherLengths.Reset();
+
+	if(ParticleStoreNum <= 0)
+	{
+		bSyntheticStart = false;
+		bSyntheticEnd = false;
+		ColourOffsets.Add(0);
+		return;
+	}
+
+	bSyntheticStart = StartTangent != nullptr;
+	bSyntheticEnd = EndTangent != nullptr;
+	SyntheticStartOffset = bSyntheticStart ? -StartTangent->GetSafeNormal() * ParticleSegmentLength : FVector::ZeroVector;
+	SyntheticEndOffset = bSyntheticEnd ? EndTangent->GetSafeNormal() * ParticleSegmentLength : FVector::ZeroVector;
+	ensure(!bSyntheticStart || !SyntheticStartOffset.IsZero());
+	ensure(!bSyntheticEnd || !SyntheticEndOffset.IsZero());
+
+	LocalOrigin = ParticleStore.Positions[ParticleStoreOffset];
+
+	const int32 NumChainParticles = ParticleStoreNum + bSyntheticStart + bSyntheticEnd;
+	ChainInverseMasses.SetNumZeroed(NumChainParticles);
+	UpdateInverseMasses(ParticleStore);
+
+	// Stretch constraints between neighbouring particles
+	for(int32 K = 0; K + 1 < NumChainParticles; K++)
+	{
+		Constraints.Add(K, K + 1, ParticleSegmentLength);
+	}
+	NumStretchConstraints = Constraints.Num();
+
+	// Stiffness constraints between every other particle, except between the two synthetic particles which can't move anything
+	if(bEnableStiffness)
+	{
+		for(int32 K = 0; K + 2 < NumChainParticles; K++)
+		{
+			const bool bBothSynthetic = bSyntheticStart && bSyntheticEnd && K == 0 && K + 2 == NumChainParticles - 1;
+			if(!bBothSynthetic)
+			{
+				Constraints.Add(K, K + 2, 2.f * ParticleSegmentLength);
+			}
+		}
+	}
+
+	// Greedily colour stretch and then stiffness constraints in chain order, giving each the lowest colour not yet used by either of its particles
+	TArray<uint32> ParticleColours;
+	TArray<int32> ConstraintColours;
+	auto AddColours = [&](int32 Begin, int32 End)
+	{
+		ParticleColours.Reset();
+		ParticleColours.SetNumZeroed(NumChainParticles);
+		ConstraintColours.SetNumUninitialized(End - Begin);
+		int32 NumColours = 0;
+		for(int32 i = Begin; i < End; i++)
+		{
+			const int32 IndexA = Constraints.IndicesA[i];
+			const int32 IndexB = Constraints.IndicesB[i];
+			const int32 Colour = FMath::CountTrailingZeros(~(ParticleColours[IndexA] | ParticleColours[IndexB]));
+			check(Colour < 32);
+			ParticleColours[IndexA] |= 1u << Colour;
+			ParticleColours[IndexB] |= 1u << Colour;
+			ConstraintColours[i - Begin] = Colour;
+			NumColours = FMath::Max(NumColours, Colour + 1);
+		}
+		for(int32 Colour = 0; Colour < NumColours; Colour++)
+		{
+			ColourOffsets.Add(ColouredConstraints.Num());
+			for(int32 i = Begin; i < End; i++)
+			{
+				if(ConstraintColours[i - Begin] == Colour)
+				{
+					ColouredConstraints.Add(Constraints.IndicesA[i], Constraints.IndicesB[i], Constraints.RestLengths[i]);
+				}
+			}
+		}
+	};
+	AddColours(0, NumStretchConstraints);
+	AddColours(NumStretchConstraints, Constraints.Num());
+	ColourOffsets.Add(ColouredConstraints.Num());
+
+	Constraints.UpdateInverseMasses(ChainInverseMasses);
+	ColouredConstraints.UpdateInverseMasses(ChainInverseMasses);
+
+	if(AnchorIndices)
+	{
+		check(AnchorIndices->Num() == ParticleStoreNum);
+		for(int32 i = 0; i < ParticleStoreNum; i++)
+		{
+			const int32 AnchorIdx = (*AnchorIndices)[i];
+			if(AnchorIdx == INDEX_NONE)
+			{
+				continue;
+			}
+			TetherParticles.Add(i + bSyntheticStart);
+			TetherAnchors.Add(AnchorIdx - ParticleStoreOffset + bSyntheticStart);
+			TetherLengths.Add(FMath::Abs(ParticleStoreOffset + i - AnchorIdx) * ParticleSegmentLength);
+		}
+	}
+}
+
+void FTetherSimulationConstraintProgram::UpdateInverseMasses(const FTetherSimulationParticleStore& ParticleStore)
+{
+	bool bChanged = false;
+	for(int32 i = 0; i < ParticleStoreNum; i++)
+	{
+		float& InverseMass = ChainInverseMasses[i + bSyntheticStart];
+		const float StoreInverseMass = ParticleStore.InverseMasses[ParticleStoreOffset + i];
+		if(InverseMass != StoreInverseMass)
+		{
+			InverseMass = StoreInverseMass;
+			bChanged = true;
+		}
+	}
+
+	if(bChanged)
+	{
+		Constraints.UpdateInverseMasses(ChainInverseMasses);
+		ColouredConstraints.UpdateInverseMasses(ChainInverseMasses);
+	}
+}
+
+void FTetherSimulationConstraintProgram::GatherPositions(const FTetherSimulationParticleStore& ParticleStore, TArray<FVector>& OutChainPositions) const
+{
+	OutChainPositions.SetNumUninitialized(GetNumChainParticles(), false);
+	if(ParticleStoreNum <= 0)
+	{
+		return;
+	}
+
+	FMemory::Memcpy(&OutChainPositions[bSyntheticStart], &ParticleStore.Positions[ParticleStoreOffset], ParticleStoreNum * sizeof(FVector));
+	if(bSyntheticStart)
+	{
+		OutChainPositions[0] = OutChainPositions[1] + SyntheticStartOffset;
+	}
+	if(bSyntheticEnd)
+	{
+		const int32 LastIdx = GetNumChainParticles() - 1;
+		OutChainPositions[LastIdx] = OutChainPositions[LastIdx - 1] + SyntheticEndOffset;
+	}
+}
+
+void FTetherSimulationConstraintProgram::ScatterPositions(const TArray<FVector>& ChainPositions, FTetherSimulationParticleStore& ParticleStore) const
+{
+	if(ParticleStoreNum <= 0)
+	{
+		return;
+	}
+
+	// Solvers never move fixed end particles, so leave them alone, as they may be anchors shared with neighbouring series simulating in parallel
+	const int32 First = ChainInverseMasses[bSyntheticStart] > 0.f ? 0 : 1;
+	const int32 End = ChainInverseMasses[bSyntheticStart + ParticleStoreNum - 1] > 0.f ? ParticleStoreNum : ParticleStoreNum - 1;
+	if(End > First)
+	{
+		FMemory::Memcpy(&ParticleStore.Positions[ParticleStoreOffset + First], &ChainPositions[bSyntheticStart + First], (End - First) * sizeof(FVector));
+	}
+}
+
+void FTetherSimulationConstraintProgram::GatherLocalPositions(const FTetherSimulationParticleStore& ParticleStore, TArray<FTetherVector3f>& OutChainPositions) const
+{
+	OutChainPositions.SetNumUninitialized(GetNumChainParticles(), false);
+	if(ParticleStoreNum <= 0)
+	{
+		return;
+	}
+
+	const FVector* Positions = &ParticleStore.Positions[ParticleStoreOffset];
+	FTetherVector3f* ChainPositions = &OutChainPositions[bSyntheticStart];
+	for(int32 i = 0; i < ParticleStoreNum; i++)
+	{
+		ChainPositions[i] = FTetherVector3f(Positions[i] - LocalOrigin);
+	}
+	if(bSyntheticStart)
+	{
+		OutChainPositions[0] = OutChainPositions[1] + FTetherVector3f(SyntheticStartOffset);
+	}
+	if(bSyntheticEnd)
+	{
+		const int32 LastIdx = GetNumChainParticles() - 1;
+		OutChainPositions[LastIdx] = OutChainPositions[LastIdx - 1] + FTetherVector3f(SyntheticEndOffset);
+	}
+}
+
+void FTetherSimulationConstraintProgram::ScatterLocalPositions(const TArray<FTetherVector3f>& ChainPositions, FTetherSimulationParticleStore& ParticleStore) const
+{
+	if(ParticleStoreNum <= 0)
+	{
+		return;
+	}
+
+	// Converting back isn't exact, so only particles the solvers could have moved are written
+	FVector* Positions = &ParticleStore.Positions[ParticleStoreOffset];
+	const float* InverseMasses = &ChainInverseMasses[bSyntheticStart];
+	const FTetherVector3f* LocalPositions = &ChainPositions[bSyntheticStart];
+	for(int32 i = 0; i < ParticleStoreNum; i++)
+	{
+		if(InverseMasses[i] > 0.f)
+		{
+			Positions[i] = LocalOrigin + FVector(LocalPositions[i]);
+		}
+	}
+}
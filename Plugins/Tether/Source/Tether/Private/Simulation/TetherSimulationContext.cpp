@@ -1,3 +1,72 @@
 // Copyright Sam Bonifacio 2021. All Rights Reserved.
 
 #include "Simulation/TetherSimulationContext.h"
+#include "Simulation/TetherSimulationConstraintProgram.h"
+
+// Most sweeps hit only a few bodies, and the hits array grows if a sweep hits more
+static constexpr int32 ReservedCollisionHits = 16;
+
+// Likewise for the bodies around a series
+static constexpr int32 ReservedCollisionCandidates = 64;
+
+void FTetherSimulationScratch::Reserve(TArrayView<const FTetherProxySimulationSegmentSeries> SeriesToSimulate)
+{
+	int32 MaxChainParticles = 0;
+	int32 MaxConstraints = 0;
+	int32 MaxParticles = 0;
+	for(const FTetherProxySimulationSegmentSeries& Series : SeriesToSimulate)
+	{
+		MaxParticles = FMath::Max(MaxParticles, Series.ParticleStoreNum);
+		if(Series.HasConstraintProgram())
+		{
+			const FTetherSimulationConstraintProgram& Program = Series.GetConstraintProgram();
+			MaxChainParticles = FMath::Max(MaxChainParticles, Program.GetNumChainParticles());
+			MaxConstraints = FMath::Max(MaxConstraints, Program.Constraints.Num());
+		}
+	}
+
+	ChainPositions.Reserve(MaxChainParticles);
+	ConstraintLambdas.Reserve(MaxConstraints);
+	ChainConstraintDirections.Reserve(MaxChainParticles);
+	ChainSystemDiagonal.Reserve(MaxChainParticles);
+	ChainSystemUpper.Reserve(MaxChainParticles);
+	ChainSystemRhs.Reserve(MaxChainParticles);
+	LocalChainPositions.Reserve(MaxChainParticles);
+	LocalChainConstraintDirections.Reserve(MaxChainParticles);
+	ImplicitDisplacement.Reserve(MaxParticles);
+	ImplicitStep.Reserve(MaxParticles);
+	ImplicitResidual.Reserve(MaxParticles);
+	ImplicitDirection.Reserve(MaxParticles);
+	ImplicitProduct.Reserve(MaxParticles);
+	ImplicitSpringDirections.Reserve(MaxParticles);
+	ImplicitSpringAxialStiffness.Reserve(MaxParticles);
+	ImplicitSpringLateralStiffness.Reserve(MaxParticles);
+	CatenaryPositions.Reserve(MaxParticles);
+	CollisionHits.Reserve(ReservedCollisionHits);
+	CollisionOverlaps.Reserve(ReservedCollisionCandidates);
+	CollisionCandidates.Reserve(ReservedCollisionCandidates);
+}
+
+SIZE_T FTetherSimulationScratch::GetAllocatedSize() const
+{
+	return ChainPositions.GetAllocatedSize()
+		+ ConstraintLambdas.GetAllocatedSize()
+		+ ChainConstraintDirections.GetAllocatedSize()
+		+ ChainSystemDiagonal.GetAllocatedSize()
+		+ ChainSystemUpper.GetAllocatedSize()
+		+ ChainSystemRhs.GetAllocatedSize()
+		+ LocalChainPositions.GetAllocatedSize()
+		+ LocalChainConstraintDirections.GetAllocatedSize()
+		+ ImplicitDisplacement.GetAllocatedSize()
+		+ ImplicitStep.GetAllocatedSize()
+		+ ImplicitResidual.GetAllocatedSize()
+		+ ImplicitDirection.GetAllocatedSize()
+		+ ImplicitProduct.GetAllocatedSize()
+		+ ImplicitSpringDirections.GetAllocatedSize()
+		+ ImplicitSpringAxialStiffness.GetAllocatedSize()
+		+ ImplicitSpringLateralStiffness.GetAllocatedSize()
+		+ CatenaryPositions.GetAllocatedSize()
+		+ CollisionHits.GetAllocatedSize()
+		+ CollisionOverlaps.GetAllocatedSize()
+		+ CollisionCandidates.GetAllocatedSize();
+}
@@ -65,6 +65,7 @@ FTetherProxySimulationSegmentSeries FTetherSimulationModel::MakeSeriesUpTo(int32
 		FTetherSimulationSegment& Segment = Segments[i];
 		Series.Segments.Add(&Segment);
 	}
+	Series.CacheParticleOffsets();
 	return Series;
 }
 
@@ -78,6 +78,11 @@ TArray<FTetherProxySimulationSegmentSeries> FTetherSimulationParams::MakeSegment
 		}
 	}
 
+	for(FTetherProxySimulationSegmentSeries& Series : AllSeries)
+	{
+		Series.CacheParticleOffsets();
+	}
+
 	return AllSeries;
 }
 
@@ -0,0 +1,181 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#include "Simulation/TetherSimulationParticleStore.h"
+#include "Simulation/TetherSimulationModel.h"
+
+void FTetherSimulationParticleStore::Build(const FTetherSimulationModel& Model)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulationParticleStore::Build"))
+
+	Positions.Reset();
+	OldPositions.Reset();
+	InverseMasses.Reset();
+	Sleeping.Reset();
+	StillTimes.Reset();
+	ParticleUniqueIds.Reset();
+	ClearCentres.Reset();
+	ClearRadii.Reset();
+	NextClearanceSubsteps.Reset();
+	ContactPlanes.Reset();
+	ContactAnchors.Reset();
+	ContactComponents.Reset();
+	ParticleSegments.Reset();
+	SegmentOffsets.Reset();
+	SegmentNumParticles.Reset();
+	ModelSegmentOffsets.Reset();
+
+	Reserve(Model.GetNumParticles(), Model.Segments.Num(), 1);
+	Append(Model);
+}
+
+void FTetherSimulationParticleStore::Reserve(int32 NumParticles, int32 NumSegments, int32 NumModels)
+{
+	Positions.Reserve(NumParticles);
+	OldPositions.Reserve(NumParticles);
+	InverseMasses.Reserve(NumParticles);
+	Sleeping.Reserve(NumParticles);
+	StillTimes.Reserve(NumParticles);
+	ParticleUniqueIds.Reserve(NumParticles);
+	ParticleSegments.Reserve(NumParticles);
+	SegmentOffsets.Reserve(NumSegments);
+	SegmentNumParticles.Reserve(NumSegments);
+	ModelSegmentOffsets.Reserve(NumModels);
+}
+
+int32 FTetherSimulationParticleStore::Append(const FTetherSimulationModel& Model)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FTetherSimulationParticleStore::Append"))
+
+	const int32 NumSegments = Model.Segments.Num();
+	const int32 NumParticles = Num() + Model.GetNumParticles();
+	const int32 FirstParticle = Num();
+	const int32 FirstSegment = SegmentOffsets.Num();
+	SegmentOffsets.AddUninitialized(NumSegments);
+	SegmentNumParticles.AddUninitialized(NumSegments);
+
+	for(int32 SegmentIndex = 0; SegmentIndex < NumSegments; SegmentIndex++)
+	{
+		const FTetherSimulationSegment& Segment = Model.Segments[SegmentIndex];
+
+		// If we already stored particles for a previous segment of this model, the first particle of this segment is the shared endpoint particle
+		const bool bHasJoiningParticle = Num() > FirstParticle;
+		SegmentOffsets[FirstSegment + SegmentIndex] = bHasJoiningParticle ? Num() - 1 : Num();
+		SegmentNumParticles[FirstSegment + SegmentIndex] = Segment.GetNumParticles();
+
+		for(int32 i = bHasJoiningParticle ? 1 : 0; i < Segment.GetNumParticles(); i++)
+		{
+			const FTetherSimulationParticle& Particle = Segment.Particles[i];
+			Positions.Add(Particle.Position);
+			OldPositions.Add(Particle.OldPosition);
+			InverseMasses.Add(Particle.bFree ? 1.f : 0.f);
+			Sleeping.Add(false);
+			StillTimes.Add(0.f);
+			ParticleUniqueIds.Add(Particle.ParticleUniqueId);
+			ParticleSegments.Add(FirstSegment + SegmentIndex);
+		}
+	}
+
+	ensure(Num() == NumParticles);
+
+	return ModelSegmentOffsets.Add(FirstSegment);
+}
+
+SIZE_T FTetherSimulationParticleStore::GetAllocatedSize() const
+{
+	return Positions.GetAllocatedSize()
+		+ OldPositions.GetAllocatedSize()
+		+ InverseMasses.GetAllocatedSize()
+		+ Sleeping.GetAllocatedSize()
+		+ StillTimes.GetAllocatedSize()
+		+ ParticleUniqueIds.GetAllocatedSize()
+		+ ClearCentres.GetAllocatedSize()
+		+ ClearRadii.GetAllocatedSize()
+		+ NextClearanceSubsteps.GetAllocatedSize()
+		+ ContactPlanes.GetAllocatedSize()
+		+ ContactAnchors.GetAllocatedSize()
+		+ ContactComponents.GetAllocatedSize()
+		+ SegmentOffsets.GetAllocatedSize()
+		+ SegmentNumParticles.GetAllocatedSize()
+		+ ParticleSegments.GetAllocatedSize()
+		+ ModelSegmentOffsets.GetAllocatedSize();
+}
+
+void FTetherSimulationParticleStore::InitCollisionCaches(bool bClearances, bool bContacts)
+{
+	if(bClearances)
+	{
+		ClearCentres = Positions;
+		ClearRadii.Reset();
+		ClearRadii.SetNumZeroed(Num());
+		NextClearanceSubsteps.Reset();
+		NextClearanceSubsteps.SetNumZeroed(Num());
+	}
+	else
+	{
+		ClearCentres.Reset();
+		ClearRadii.Reset();
+		NextClearanceSubsteps.Reset();
+	}
+
+	if(bContacts)
+	{
+		ContactPlanes.Reset();
+		ContactPlanes.SetNumZeroed(Num());
+		ContactAnchors = Positions;
+		ContactComponents.Reset();
+		ContactComponents.SetNum(Num());
+	}
+	else
+	{
+		ContactPlanes.Reset();
+		ContactAnchors.Reset();
+		ContactComponents.Reset();
+	}
+}
+
+void FTetherSimulationParticleStore::WriteToSegment(FTetherSimulationSegment& Segment, int32 ModelIndex) const
+{
+	const int32 SegmentIndex = ModelSegmentOffsets.IsValidIndex(ModelIndex) ? GetSegmentIndex(ModelIndex, Segment.SegmentUniqueId) : INDEX_NONE;
+	if(!ensure(SegmentOffsets.IsValidIndex(SegmentIndex) && SegmentNumParticles[SegmentIndex] == Segment.GetNumParticles()))
+	{
+		return;
+	}
+
+	// This also synchronizes the joining particle with the last particle of the previous segment
+	const int32 Offset = SegmentOffsets[SegmentIndex];
+	for(int32 i = 0; i < Segment.GetNumParticles(); i++)
+	{
+		Segment.Particles[i] = MakeParticle(Offset + i);
+	}
+}
+
+void FTetherSimulationParticleStore::SetSleeping(int32 Index, bool bSleep)
+{
+	if(!ensure(bSleep ? IsFree(Index) : IsSleeping(Index)))
+	{
+		return;
+	}
+
+	Sleeping[Index] = bSleep;
+	InverseMasses[Index] = bSleep ? 0.f : 1.f;
+	StillTimes[Index] = 0.f;
+	if(bSleep)
+	{
+		// Hold the particle still while it sleeps
+		OldPositions[Index] = Positions[Index];
+	}
+}
+
+FTetherSimulationParticle FTetherSimulationParticleStore::MakeParticle(int32 Index) const
+{
+	// Sleeping particles are still free as far as the model is concerned
+	FTetherSimulationParticle Particle(IsFree(Index) || IsSleeping(Index), Positions[Index]);
+	Particle.OldPosition = OldPositions[Index];
+	Particle.ParticleUniqueId = ParticleUniqueIds[Index];
+	return Particle;
+}
+
+int32 FTetherSimulationParticleStore::FindParticleUniqueId(uint32 ParticleUniqueId) const
+{
+	return ParticleUniqueIds.IndexOfByKey(ParticleUniqueId);
+}
@@ -3,6 +3,7 @@
 #include "Simulation/TetherSimulationSegment.h"
 #include "CableSplineUtils.h"
 #include "TetherLogs.h"
+#include "Simulation/TetherCatenary.h"
 
 TArray<FVector> FTetherSimulationSegment::GetParticleLocations() const
 {
@@ -133,4 +134,80 @@ void FTetherSimulationSegment::BuildParticles(float ParticleSegmentLength, bool
 	}
 
 	SimulationTime = 0.f;
+	RestTime = 0.f;
+}
+
+bool FTetherSimulationSegment::ResampleParticles(const TArray<FTetherSimulationParticle>& PreviousParticles)
+{
+	const int32 NumPreviousParticles = PreviousParticles.Num();
+	if(NumPreviousParticles < 2 || GetNumParticles() < 2)
+	{
+		return false;
+	}
+
+	// Cumulative length along the previous particles
+	TArray<float> PreviousDistances;
+	PreviousDistances.SetNumUninitialized(NumPreviousParticles);
+	PreviousDistances[0] = 0.f;
+	for(int32 i = 1; i < NumPreviousParticles; i++)
+	{
+		PreviousDistances[i] = PreviousDistances[i - 1] + FVector::Dist(PreviousParticles[i - 1].Position, PreviousParticles[i].Position);
+	}
+	const float PreviousLength = PreviousDistances.Last();
+	if(PreviousLength <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Current particles were built along the spline, so their endpoints are the new anchor locations
+	const FVector StartOffset = Particles[0].Position - PreviousParticles[0].Position;
+	const FVector EndOffset = Particles.Last().Position - PreviousParticles.Last().Position;
+
+	const int32 NumParticles = GetNumParticles();
+	int32 PreviousIdx = 0;
+	for(int32 i = 0; i < NumParticles; i++)
+	{
+		const float Alpha = (float)i / (NumParticles - 1);
+		const float Distance = Alpha * PreviousLength;
+		while(PreviousIdx < NumPreviousParticles - 2 && PreviousDistances[PreviousIdx + 1] < Distance)
+		{
+			PreviousIdx++;
+		}
+
+		const float SpanLength = PreviousDistances[PreviousIdx + 1] - PreviousDistances[PreviousIdx];
+		const float SpanAlpha = SpanLength > KINDA_SMALL_NUMBER ? FMath::Clamp((Distance - PreviousDistances[PreviousIdx]) / SpanLength, 0.f, 1.f) : 0.f;
+		const FVector PreviousPosition = FMath::Lerp(PreviousParticles[PreviousIdx].Position, PreviousParticles[PreviousIdx + 1].Position, SpanAlpha);
+
+		FTetherSimulationParticle& Particle = Particles[i];
+		Particle.Position = PreviousPosition + FMath::Lerp(StartOffset, EndOffset, Alpha);
+		Particle.OldPosition = Particle.Position;
+		ensure(!Particle.Position.ContainsNaN());
+	}
+
+	return true;
+}
+
+bool FTetherSimulationSegment::PlaceParticlesOnCatenary(const FVector& CableForce)
+{
+	const int32 NumParticles = GetNumParticles();
+	if(NumParticles < 2)
+	{
+		return false;
+	}
+
+	FTetherCatenary Catenary;
+	if(!FTetherCatenary::Solve(Particles[0].Position, Particles.Last().Position, Length, CableForce, Catenary))
+	{
+		return false;
+	}
+
+	for(int32 i = 1; i < NumParticles - 1; i++)
+	{
+		FTetherSimulationParticle& Particle = Particles[i];
+		Particle.Position = Catenary.GetLocationAtDistance((double)Length * i / (NumParticles - 1));
+		Particle.OldPosition = Particle.Position;
+		ensure(!Particle.Position.ContainsNaN());
+	}
+
+	return true;
 }
@@ -1,6 +1,9 @@
 // Copyright Sam Bonifacio 2021. All Rights Reserved.
 
 #include "Simulation/TetherSimulationSegmentSeries.h"
+#include "Simulation/TetherCableSimulationOptions.h"
+#include "Simulation/TetherSimulationParticleStore.h"
+#include "Simulation/TetherSimulationConstraintProgram.h"
 
 int32 FTetherSimulationSegmentSeries::GetNumSegments() const
 {
@@ -54,6 +57,10 @@ int32 FTetherSimulationSegmentSeries::IndexOfSegmentUniqueId(int32 SegmentUnique
 
 int32 FTetherSimulationSegmentSeries::GetNumParticles(bool bIncludeDuplicates) const
 {
+    if(CachedParticleOffsets.IsValid())
+    {
+        return bIncludeDuplicates ? CachedParticleOffsets->DuplicateParticleOffsets.Last() : CachedParticleOffsets->ParticleOffsets.Last();
+    }
     if(GetNumSegments() == 0)
     {
         return 0;
@@ -81,6 +88,10 @@ int32 FTetherSimulationSegmentSeries::GetNumParticles(bool bIncludeDuplicates) c
 
 int32 FTetherSimulationSegmentSeries::GetStartingParticleIndexForSegment(int32 SegmentIndex) const
 {
+    if(CachedParticleOffsets.IsValid())
+    {
+        return CachedParticleOffsets->ParticleOffsets[SegmentIndex];
+    }
     int32 LastIndex = 0;
     for (int32 i=0; i< SegmentIndex ; i++)
     {
@@ -123,6 +134,16 @@ FSplineSegmentInfo FTetherSimulationSegmentSeries::GetSplineSegmentInfo() const
 const FTetherSimulationSegment* FTetherSimulationSegmentSeries::GetSegmentWithParticle(int32 Index, bool bIncludeDuplicates) const
 {
     check(Index >= 0);
+    if(CachedParticleOffsets.IsValid())
+    {
+        const TArray<int32>& ParticleSegments = bIncludeDuplicates ? CachedParticleOffsets->DuplicateParticleSegments : CachedParticleOffsets->ParticleSegments;
+        if(!ensure(ParticleSegments.IsValidIndex(Index)))
+        {
+            // Index out of range
+            return GetLastSegmentConst();
+        }
+        return GetSegmentConst(ParticleSegments[Index]);
+    }
     int32 CurrentSize = 0;
     for (int32 i = 0; i < GetNumSegments(); i++)
     {
@@ -161,6 +182,18 @@ FTetherSimulationParticle& FTetherSimulationSegmentSeries::GetParticle(int32 Ind
 const FTetherSimulationParticle& FTetherSimulationSegmentSeries::GetParticleConst(int32 Index, bool bIncludeDuplicates) const
 {
     check(Index >= 0);
+    if(CachedParticleOffsets.IsValid())
+    {
+        const TArray<int32>& ParticleSegments = bIncludeDuplicates ? CachedParticleOffsets->DuplicateParticleSegments : CachedParticleOffsets->ParticleSegments;
+        if(!ensure(ParticleSegments.IsValidIndex(Index)))
+        {
+            // Index out of range
+            return GetLastSegmentConst()->Particles.Last();
+        }
+        const int32 SegmentIndex = ParticleSegments[Index];
+        const TArray<int32>& ParticleOffsets = bIncludeDuplicates ? CachedParticleOffsets->DuplicateParticleOffsets : CachedParticleOffsets->ParticleOffsets;
+        return GetSegmentConst(SegmentIndex)->Particles[Index - ParticleOffsets[SegmentIndex]];
+    }
     int32 CurrentSize = 0;
     for (int32 i = 0; i < GetNumSegments(); i++)
     {
@@ -243,6 +276,23 @@ float FTetherSimulationSegmentSeries::GetSimulatedTime() const
     return GetSegmentConst(0)->SimulationTime;
 }
 
+void FTetherSimulationSegmentSeries::SetRestTime(float RestTime)
+{
+    for(int32 i=0;i<GetNumSegments();i++)
+    {
+        GetSegment(i)->RestTime = RestTime;
+    }
+}
+
+float FTetherSimulationSegmentSeries::GetRestTime() const
+{
+    if(!ensure(GetNumSegments() > 0))
+    {
+        return 0.f;
+    }
+    return GetSegmentConst(0)->RestTime;
+}
+
 bool FTetherSimulationSegmentSeries::IsValid() const
 {
     for(int32 i=0;i<GetNumSegments();i++)
@@ -255,6 +305,47 @@ bool FTetherSimulationSegmentSeries::IsValid() const
     return true;
 }
 
+void FTetherSimulationSegmentSeries::CacheParticleOffsets()
+{
+    TSharedRef<FTetherSimulationSegmentSeriesParticleOffsets> Offsets = MakeShared<FTetherSimulationSegmentSeriesParticleOffsets>();
+
+    const int32 NumSegments = GetNumSegments();
+    Offsets->ParticleOffsets.SetNumUninitialized(NumSegments + 1);
+    Offsets->DuplicateParticleOffsets.SetNumUninitialized(NumSegments + 1);
+
+    int32 NumParticles = 0;
+    int32 NumDuplicateParticles = 0;
+    for (int32 i = 0; i < NumSegments; i++)
+    {
+        const int32 SegmentNumParticles = GetSegmentConst(i)->GetNumParticles();
+
+        // If we already have particles for a previous segment, the first particle of this segment is the shared endpoint particle
+        const int32 Offset = NumParticles > 0 ? NumParticles - 1 : 0;
+        Offsets->ParticleOffsets[i] = Offset;
+        for (int32 ParticleIndex = NumParticles; ParticleIndex < Offset + SegmentNumParticles; ParticleIndex++)
+        {
+            Offsets->ParticleSegments.Add(i);
+        }
+        NumParticles = FMath::Max(NumParticles, Offset + SegmentNumParticles);
+
+        Offsets->DuplicateParticleOffsets[i] = NumDuplicateParticles;
+        for (int32 ParticleIndex = 0; ParticleIndex < SegmentNumParticles; ParticleIndex++)
+        {
+            Offsets->DuplicateParticleSegments.Add(i);
+        }
+        NumDuplicateParticles += SegmentNumParticles;
+    }
+    Offsets->ParticleOffsets[NumSegments] = NumParticles;
+    Offsets->DuplicateParticleOffsets[NumSegments] = NumDuplicateParticles;
+
+    CachedParticleOffsets = Offsets;
+}
+
+void FTetherSimulationSegmentSeries::ResetParticleOffsets()
+{
+    CachedParticleOffsets.Reset();
+}
+
 int32 FTetherProxySimulationSegmentSeries::GetNumSegments() const
 {
     return Segments.Num();
@@ -269,3 +360,157 @@ const FTetherSimulationSegment* FTetherProxySimulationSegmentSeries::GetSegmentC
 {
     return Segments[SegmentIndex];
 }
+
+
+void FTetherProxySimulationSegmentSeries::BindParticleStore(FTetherSimulationParticleStore& InParticleStore, int32 ModelIndex)
+{
+    ParticleStore = &InParticleStore;
+    ParticleStoreOffset = 0;
+    ParticleStoreNum = 0;
+
+    if(!ensure(Segments.Num() > 0))
+    {
+        return;
+    }
+
+    ParticleStoreOffset = InParticleStore.SegmentOffsets[InParticleStore.GetSegmentIndex(ModelIndex, Segments[0]->SegmentUniqueId)];
+    for(const FTetherSimulationSegment* Segment : Segments)
+    {
+        if(Segment->GetNumParticles() > 0)
+        {
+            ParticleStoreNum = InParticleStore.GetSegmentEnd(InParticleStore.GetSegmentIndex(ModelIndex, Segment->SegmentUniqueId)) - ParticleStoreOffset;
+        }
+    }
+
+    ensure(ParticleStoreNum == GetNumParticles());
+}
+
+void FTetherProxySimulationSegmentSeries::BuildTethers()
+{
+    if(!ensure(IsBoundToParticleStore()))
+    {
+        return;
+    }
+
+    TSharedRef<FTetherSimulationSegmentSeriesTethers> NewTethers = MakeShared<FTetherSimulationSegmentSeriesTethers>();
+    NewTethers->AnchorIndices.Init(INDEX_NONE, ParticleStoreNum);
+
+    // Sweep forwards then backwards, keeping whichever fixed particle is fewer particles away
+    const int32 FirstParticle = ParticleStoreOffset;
+    const int32 EndParticle = ParticleStoreOffset + ParticleStoreNum;
+    int32 LastAnchor = INDEX_NONE;
+    for(int32 ParticleIdx = FirstParticle; ParticleIdx < EndParticle; ParticleIdx++)
+    {
+        if(!ParticleStore->IsFree(ParticleIdx))
+        {
+            LastAnchor = ParticleIdx;
+        }
+        else
+        {
+            NewTethers->AnchorIndices[ParticleIdx - FirstParticle] = LastAnchor;
+        }
+    }
+    LastAnchor = INDEX_NONE;
+    for(int32 ParticleIdx = EndParticle - 1; ParticleIdx >= FirstParticle; ParticleIdx--)
+    {
+        if(!ParticleStore->IsFree(ParticleIdx))
+        {
+            LastAnchor = ParticleIdx;
+            continue;
+        }
+        int32& Anchor = NewTethers->AnchorIndices[ParticleIdx - FirstParticle];
+        if(LastAnchor != INDEX_NONE && (Anchor == INDEX_NONE || LastAnchor - ParticleIdx < ParticleIdx - Anchor))
+        {
+            Anchor = LastAnchor;
+        }
+    }
+
+    Tethers = NewTethers;
+}
+
+void FTetherProxySimulationSegmentSeries::BuildConstraintProgram(bool bEnableStiffness, bool bUseStartTangent, bool bUseEndTangent)
+{
+    if(!ensure(IsBoundToParticleStore()))
+    {
+        return;
+    }
+
+    const FSplineSegmentInfo SplineSegmentInfo = GetSplineSegmentInfo();
+    const FVector* StartTangent = bUseStartTangent ? &SplineSegmentInfo.StartLeaveTangent : nullptr;
+    const FVector* EndTangent = bUseEndTangent ? &SplineSegmentInfo.EndArriveTangent : nullptr;
+    const TArray<int32>* AnchorIndices = HasTethers() ? &GetTethers().AnchorIndices : nullptr;
+
+    TSharedRef<FTetherSimulationConstraintProgram> NewProgram = MakeShared<FTetherSimulationConstraintProgram>();
+    NewProgram->Build(*ParticleStore, ParticleStoreOffset, ParticleStoreNum, GetParticleSegmentLength(), bEnableStiffness, StartTangent, EndTangent, AnchorIndices);
+
+    ConstraintProgram = NewProgram;
+}
+
+bool FTetherProxySimulationSegmentSeries::RebuildInvalidatedSegments(TFunctionRef<void(FTetherSimulationSegment&)> BuildParticles, const FTetherCableSimulationOptions& SimulationOptions, bool bWarmStart, bool& bOutWarmStarted)
+{
+    bOutWarmStarted = false;
+
+    // Rebuild the whole series if any contained segments were invalidated
+    bool bRebuildSeries = false;
+    // Only warm start if every segment of the series has previously simulated particles to start from
+    bool bWarmStartSeries = bWarmStart;
+    for(const FTetherSimulationSegment* Segment : Segments)
+    {
+        if(Segment->IsInvalidated())
+        {
+            bRebuildSeries = true;
+        }
+        if(Segment->GetNumParticles() < 2 || Segment->SimulationTime <= 0.f)
+        {
+            bWarmStartSeries = false;
+        }
+    }
+
+    if(!bRebuildSeries)
+    {
+        return false;
+    }
+
+    TArray<TArray<FTetherSimulationParticle>> PreviousParticles;
+    if(bWarmStartSeries)
+    {
+        for(const FTetherSimulationSegment* Segment : Segments)
+        {
+            PreviousParticles.Add(Segment->Particles);
+        }
+    }
+
+    for(FTetherSimulationSegment* Segment : Segments)
+    {
+        BuildParticles(*Segment);
+    }
+
+    if(bWarmStartSeries)
+    {
+        // Move the rebuilt particles onto the previous shape of the cable
+        bool bResampled = true;
+        for(int32 SeriesSegmentIndex = 0; SeriesSegmentIndex < Segments.Num(); SeriesSegmentIndex++)
+        {
+            bResampled &= Segments[SeriesSegmentIndex]->ResampleParticles(PreviousParticles[SeriesSegmentIndex]);
+        }
+
+        for(FTetherSimulationSegment* Segment : Segments)
+        {
+            if(bResampled)
+            {
+                // Start the series close enough to the end of the simulation duration that only the settle window is simulated
+                Segment->SimulationTime = FMath::Max(SimulationOptions.SimulationDuration - SimulationOptions.WarmStartSettleDuration, 0.f);
+            }
+            else
+            {
+                // Couldn't resample every segment, so fall back to simulating the whole series from the spline
+                BuildParticles(*Segment);
+            }
+        }
+        bOutWarmStarted = bResampled;
+    }
+
+    // Particle offsets of the series are no longer valid
+    ResetParticleOffsets();
+    return true;
+}
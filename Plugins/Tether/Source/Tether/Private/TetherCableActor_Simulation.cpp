@@ -6,6 +6,7 @@
 #include "TetherDebugDrawHelpers.h"
 #include "TetherLogs.h"
 #include "Mesh/TetherCableMeshComponent.h"
+#include "Simulation/TetherCollisionSnapshot.h"
 #include "Simulation/TetherSimulation.h"
 #if WITH_EDITOR
 #include "Editor.h"
@@ -595,40 +596,39 @@ void ATetherCableActor::ResetInvalidatedSegmentsSimulationState(FTetherSimulatio
 
 	TArray<FTetherProxySimulationSegmentSeries> SimulationSeries = MakeSimulationParams(Model).MakeSegmentSeriesToSimulate(Model, true);
 
+	const FTetherCableSimulationOptions& SimulationOptions = CableProperties.SimulationOptions;
+	const bool bAllowWarmStart = SimulationOptions.ShouldUseWarmStart(bRealtimeSimulating);
+
 	int32 NumSegmentsRebuilt = 0;
+	int32 NumSeriesWarmStarted = 0;
 	for(int32 i=0; i< SimulationSeries.Num();i++)
 	{
 		FTetherProxySimulationSegmentSeries& Series = SimulationSeries[i];
-		
-		// Work out whether to rebuild the whole series (if any contained segments were invalidated)
-		bool bRebuildSeries = false;
-		for(FTetherSimulationSegment* Segment : Series.Segments)
-		{
-			if(Segment->IsInvalidated())
-			{
-				bRebuildSeries = true;
-				break;
-			}
-		}
-		
-		for (FTetherSimulationSegment* Segment : Series.Segments)
+
+		for (const FTetherSimulationSegment* Segment : Series.Segments)
 		{
 			UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s: Segment %i"), *GetHumanReadableName(), Segment->SegmentUniqueId);
 			UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s:     Start: %s"), *GetHumanReadableName(), *Segment->SplineSegmentInfo.StartLocation.ToCompactString());
 			UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s:     End: %s"), *GetHumanReadableName(), *Segment->SplineSegmentInfo.EndLocation.ToCompactString());
 			UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s:     Length: %f"), *GetHumanReadableName(), Segment->Length);
 			UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s:     Invalidated: %i"), *GetHumanReadableName(), (int32)Segment->IsInvalidated());
-			UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s:     Rebuild: %i"), *GetHumanReadableName(), (int32)bRebuildSeries);
-			
-			if(bRebuildSeries)
-			{
-				BuildParticlesForSegment(Model, Segment->SegmentUniqueId);
-				NumSegmentsRebuilt++;
-			}
 		}
-		
+
+		bool bWarmStarted = false;
+		const bool bRebuilt = Series.RebuildInvalidatedSegments([&](FTetherSimulationSegment& Segment)
+		{
+			BuildParticlesForSegment(Model, Segment.SegmentUniqueId);
+		}, SimulationOptions, bAllowWarmStart, bWarmStarted);
+
+		UE_LOG(LogTetherCable, VeryVerbose, TEXT("%s: Series %i: Rebuild: %i"), *GetHumanReadableName(), i, (int32)bRebuilt);
+		if(bRebuilt)
+		{
+			NumSegmentsRebuilt += Series.Segments.Num();
+		}
+		NumSeriesWarmStarted += bWarmStarted;
 	}
 
+	UE_LOG(LogTetherCable, Verbose, TEXT("%s: Warm started %i series"), *GetHumanReadableName(), NumSeriesWarmStarted);
 	UE_LOG(LogTetherCable, Verbose, TEXT("%s: Rebuilt %i segments"), *GetHumanReadableName(), NumSegmentsRebuilt);
 
 	uint32 NextIndex = 0;
@@ -651,9 +651,21 @@ void ATetherCableActor::BuildParticlesForSegment(FTetherSimulationModel& Model,
 
 	FTetherSimulationSegment& Segment = Segments[SegmentIndex];
 
-	const bool bStartFixed = GetPointSegmentDefinitions()[SegmentIndex]->SimulationOptions.bFixedAnchorPoint;
-	const bool bEndFixed = GetPointSegmentDefinitions()[SegmentIndex + 1]->SimulationOptions.bFixedAnchorPoint;
-	Segment.BuildParticles(CableProperties.GetDesiredParticleDistance(), bStartFixed, bEndFixed);
+	const FTetherSegmentSimulationOptions& StartOptions = GetPointSegmentDefinitions()[SegmentIndex]->SimulationOptions;
+	const FTetherSegmentSimulationOptions& EndOptions = GetPointSegmentDefinitions()[SegmentIndex + 1]->SimulationOptions;
+	Segment.BuildParticles(CableProperties.GetDesiredParticleDistance(), StartOptions.bFixedAnchorPoint, EndOptions.bFixedAnchorPoint);
+
+	const FTetherCableSimulationOptions& SimulationOptions = CableProperties.SimulationOptions;
+	if(SimulationOptions.InitialParticlePlacement == ETetherInitialParticlePlacement::Catenary)
+	{
+		// The catenary ignores tangents, so keep the spline shape when they are enforced
+		const bool bUseTangents = SimulationOptions.bEnableStiffness && (StartOptions.ShouldUseSplineTangents() || EndOptions.ShouldUseSplineTangents());
+		if(!bUseTangents && Segment.PlaceParticlesOnCatenary(GetCableForce()))
+		{
+			// Constraints are already satisfied, so easing them in would only let the cable sag further before pulling it back
+			Segment.SimulationTime = FMath::Min(SimulationOptions.ConstraintsEaseInTime, SimulationOptions.SimulationDuration);
+		}
+	}
 }
 
 bool ATetherCableActor::PrepareForSimulation(FTetherSimulationModel& InitialModel, FTetherSimulationParams& Params)
@@ -688,9 +700,47 @@ bool ATetherCableActor::PrepareForSimulation(FTetherSimulationModel& InitialMode
 	// Set base world transform on the simulation model
 	InitialModel.SimulationBaseWorldTransform = GetActorTransform();
 
+	if(Params.SimulationOptions.ShouldUseCollisionSnapshot())
+	{
+		UpdateCollisionSnapshot(InitialModel, Params);
+	}
+
 	return true;
 }
 
+void ATetherCableActor::UpdateCollisionSnapshot(const FTetherSimulationModel& Model, FTetherSimulationParams& Params)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("ATetherCableActor::UpdateCollisionSnapshot"))
+
+	const FBox RequiredBounds = FTetherCollisionSnapshot::GetSimulationBounds(Model, Params);
+	if(!CollisionSnapshot.IsValid() || !CollisionSnapshot->IsUpToDate(Params, RequiredBounds))
+	{
+		// Leave some room around the cable, so that small edits can reuse the snapshot
+		const FBox SnapshotBounds = RequiredBounds.ExpandBy(0.25f * RequiredBounds.GetExtent().GetMax());
+		TSharedRef<FTetherCollisionSnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FTetherCollisionSnapshot, ESPMode::ThreadSafe>();
+		NewSnapshot->Build(Params, SnapshotBounds);
+		CollisionSnapshot = NewSnapshot;
+		UE_LOG(LogTetherCable, Verbose, TEXT("%s: Built collision snapshot of %i primitives from %i bodies"), *GetHumanReadableName(), NewSnapshot->GetNumPrimitives(), NewSnapshot->GetNumBodies());
+	}
+
+	if(Params.SimulationOptions.ShouldUseDistanceField())
+	{
+		// Samples must be close enough to resolve the cable's width, and reach far enough to interpolate up to its surface
+		const float CellSize = Params.CollisionWidth * Params.SimulationOptions.DistanceFieldCellScale;
+		const float MaxDistance = 0.5f * Params.CollisionWidth + 2.f * CellSize;
+		if(!CollisionSnapshot->GetDistanceField().WasBuiltWith(CellSize, MaxDistance))
+		{
+			// The current snapshot may be shared with a simulation that is still running, so bake into a copy
+			TSharedRef<FTetherCollisionSnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FTetherCollisionSnapshot, ESPMode::ThreadSafe>(*CollisionSnapshot);
+			NewSnapshot->BuildDistanceField(CellSize, MaxDistance);
+			CollisionSnapshot = NewSnapshot;
+			UE_LOG(LogTetherCable, Verbose, TEXT("%s: Built collision distance field of %i bricks"), *GetHumanReadableName(), NewSnapshot->GetDistanceField().GetNumBricks());
+		}
+	}
+
+	Params.CollisionSnapshot = CollisionSnapshot;
+}
+
 
 FTetherSimulationResultInfo ATetherCableActor::PerformSimulation(FTetherSimulationModel& InitialModel, float DeltaTime, bool bIgnoreSegmentsSimulatingAsync, EMeshBuildInstruction BuildMesh, bool bVerboseLogging)
 {
@@ -733,7 +783,7 @@ FTetherSimulationResultInfo ATetherCableActor::PerformSimulation(FTetherSimulati
 		}
 	}
 	
-	const FTetherSimulationResultInfo ResultInfo = FTetherSimulation::PerformSimulation(InitialModel, DeltaTime, Params);
+	const FTetherSimulationResultInfo ResultInfo = FTetherSimulation::PerformSimulation(InitialModel, DeltaTime, Params, SynchronousParticleStore, SynchronousScratch);
 
 	Resources.ReleaseResources();
 
@@ -961,6 +1011,7 @@ void ATetherCableActor::HandleSimulationComplete(const FTetherSimulationResultIn
 		// Update particles of active simulation
 		ActiveSimulationModel.Segments[i].Particles = SimulatedModel.Segments[i].Particles;
 		ActiveSimulationModel.Segments[i].SimulationTime = SimulatedModel.Segments[i].SimulationTime;
+		ActiveSimulationModel.Segments[i].RestTime = SimulatedModel.Segments[i].RestTime;
 	}
 
 	ActiveSimulationModel.SimulationBaseWorldTransform = SimulatedModel.SimulationBaseWorldTransform;
@@ -6,6 +6,56 @@
 #include "Engine/CollisionProfile.h"
 #include "TetherCableSimulationOptions.generated.h"
 
+UENUM(BlueprintType)
+enum class ETetherConstraintSolver : uint8
+{
+	/** Solves each constraint one at a time along the cable */
+	Sequential,
+	/** Solves sets of independent constraints (even and odd particle pairs) as vectorized batches */
+	Coloured,
+	/**
+	 * Solves all constraints between neighbouring particles at once as a linear system along the cable, in a single pass per substep
+	 * Stiffness constraints are solved with a single sweep per substep beforehand
+	 */
+	Direct
+};
+
+UENUM(BlueprintType)
+enum class ETetherIntegrator : uint8
+{
+	/** Moves each particle explicitly by its velocity and gravity, which needs short substeps to stay stable */
+	Verlet,
+	/**
+	 * Moves particles with backward Euler, solving the springs between neighbouring particles as a sparse system along the cable with a few Newton iterations
+	 * Stays stable with substeps an order of magnitude longer than Verlet
+	 */
+	Implicit
+};
+
+UENUM(BlueprintType)
+enum class ETetherCollisionMode : uint8
+{
+	/** Sweeps each particle along the path it moved during the substep */
+	Sweep,
+	/**
+	 * Bakes the distances to the collision around the cable into a sparse grid before simulating, and pushes particles out of it with a single lookup each
+	 * Much cheaper than sweeping, but particles that move further than the cable is wide in a substep may pass through thin collision
+	 */
+	DistanceField
+};
+
+UENUM(BlueprintType)
+enum class ETetherInitialParticlePlacement : uint8
+{
+	/** Places particles along the guide spline */
+	Spline,
+	/**
+	 * Places particles on the catenary that a cable of the segment's length would hang in between its end points
+	 * Falls back to the guide spline for segments that use spline tangents
+	 */
+	Catenary
+};
+
 USTRUCT(BlueprintType)
 struct TETHER_API FTetherCableSimulationOptions
 {
@@ -27,6 +77,29 @@ public:
 	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.001", UIMin = "0.005", UIMax = "0.1"))
 	float SubstepTime = 0.003f;
 
+	/**
+	 *  Vary the substep time while simulating, taking larger substeps once the cable has slowed down and smaller ones while it moves quickly.
+	 *  The substep time is chosen from the state of the cable at the start of each substep, so the result is still deterministic.
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableAdaptiveSubstepping = false;
+
+	/** Shortest substep time in seconds when using adaptive substepping */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0005", UIMax = "0.01", EditCondition = bEnableAdaptiveSubstepping))
+	float MinSubstepTime = 0.001f;
+
+	/** Longest substep time in seconds when using adaptive substepping */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.001", UIMax = "0.05", EditCondition = bEnableAdaptiveSubstepping))
+	float MaxSubstepTime = 0.012f;
+
+	/** Maximum distance any particle may travel in a single substep, as a fraction of the collision width */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.01", UIMax = "1.0", EditCondition = bEnableAdaptiveSubstepping))
+	float AdaptiveSubstepMaxTravel = 0.5f;
+
+	/** Stretch of any constraint between neighbouring particles, as a fraction of the distance between particles, above which the substep time is reduced */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.001", UIMax = "0.2", EditCondition = bEnableAdaptiveSubstepping))
+	float AdaptiveSubstepStretchThreshold = 0.02f;
+
 
 	/** Adds stiffness constraints to the cable simulation */
 	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
@@ -36,6 +109,62 @@ public:
 	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", UIMax = "32", DisplayName="Stiffness"))
 	int32 StiffnessSolverIterations = 4;
 
+	/**
+	 *  How constraints between particles are solved each iteration.
+	 *  Coloured is faster for long cables, but propagates corrections along the cable differently so may need more iterations for the same stiffness.
+	 *  Direct ignores the number of iterations and solves the cable exactly once per substep, which is fastest for long cables that should not stretch.
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	ETetherConstraintSolver ConstraintSolver = ETetherConstraintSolver::Sequential;
+
+	/**
+	 *  Solve constraints in single precision relative to the start of each series, rather than in double precision world space.
+	 *  Halves the memory the solver works through and doubles the width of its vectorized batches, at the cost of a tiny difference in the result.
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableLocalSpaceSolver = false;
+
+	/**
+	 *  How particles are moved by their velocity and gravity each substep, before constraints are solved.
+	 *  Implicit is stable with much longer substeps, so cables that don't collide much can be simulated with far fewer substeps.
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	ETetherIntegrator Integrator = ETetherIntegrator::Verlet;
+
+	/** Newton iterations of the implicit integrator each substep */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", UIMax = "8", EditCondition = "Integrator == ETetherIntegrator::Implicit"))
+	int32 ImplicitNewtonIterations = 2;
+
+	/** Conjugate gradient iterations of the implicit integrator for each Newton iteration */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", UIMax = "64", EditCondition = "Integrator == ETetherIntegrator::Implicit"))
+	int32 ImplicitSolverIterations = 16;
+
+	/** Stiffness per unit mass of the springs between neighbouring particles in the implicit integrator */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "1000000.0", EditCondition = "Integrator == ETetherIntegrator::Implicit"))
+	float ImplicitStretchStiffness = 100000.f;
+
+	/**
+	 *  Tether each free particle to the nearest fixed anchor point, so that it can never be further from the anchor than the length of cable between them.
+	 *  Stops long cables stretching under their own weight regardless of the number of solver iterations, so fewer iterations and a shorter simulation duration may be used.
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableTethers = false;
+
+	/**
+	 *  Solve constraints with XPBD, so that how much the cable stretches and bends is controlled by compliance rather than by the number of solver iterations.
+	 *  This allows fewer iterations and larger substeps for a similar result. Compliant constraints are always solved sequentially.
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableCompliance = false;
+
+	/** Compliance (inverse stiffness) of the constraints between neighbouring particles. Zero is perfectly inextensible. */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "0.001", EditCondition = bEnableCompliance))
+	float StretchCompliance = 0.f;
+
+	/** Compliance (inverse stiffness) of the stiffness constraints between every other particle. Higher values make the cable bend more easily. */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "0.001", EditCondition = bEnableCompliance))
+	float StiffnessCompliance = 0.00001f;
+
 	/**
 	 *  Damps velocity of cable particles, reducing cable sway
 	 *  This may allow the cable to come to rest faster, therefore requiring less simulation time, at the cost of realism
@@ -55,6 +184,7 @@ public:
 	 *  If true, the cable will collide with itself while simulating.
 	 *  Adds further simulation time.
 	 *  Requires CVar Tether.SelfCollision 1
+	 *  The cable's own collision moves while it simulates, so the collision snapshot, distance field collision, collision culling and contact caching are not used with self-collision.
 	 */
 	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = bEnableCollision))
 	bool bEnableSelfCollision = true;
@@ -74,6 +204,49 @@ public:
 	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", ClampMax = "1.0", EditCondition = bEnableCollision))
 	float CollisionFriction = 0.2f;
 
+	/**
+	 * Copy the collision around the cable into a private structure before simulating, and sweep particles against the copy instead of the physics scene
+	 * Sweeps no longer query or lock the physics scene, so they are much cheaper and always give the same hits
+	 * The copy is kept and reused by later simulations of the cable until anything around it is added, removed, moved or changed
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = bEnableCollision))
+	bool bEnableCollisionSnapshot = false;
+
+	/**
+	 * Instead of sweeping each particle through the physics scene, find everything around each series with a single overlap per substep,
+	 * and sweep each particle only against the bodies from the overlap that its sweep could touch
+	 * Gives the same hits, but avoids the setup and filtering of a scene query per particle
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = bEnableCollision))
+	bool bEnableBatchedCollisionQueries = false;
+
+	/** Occasionally measure how far each particle is from the nearest collision, and skip sweeping it while it stays within that distance of where it was measured */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = bEnableCollision))
+	bool bEnableCollisionCulling = false;
+
+	/** Furthest distance from collision to measure for collision culling. Larger distances let particles move further without sweeping, but are more likely to find something */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1.0", UIMax = "200.0", EditCondition = "bEnableCollision && bEnableCollisionCulling"))
+	float CollisionCullingDistance = 50.f;
+
+	/**
+	 * Remember the plane of the last surface each particle hit, and collide with that plane instead of sweeping while the particle stays close to where it hit and keeps pressing into it
+	 * Makes particles resting on surfaces much cheaper to simulate, but while they press into their cached surface they can't find any other collision until they slide or lift further than the margin
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = bEnableCollision))
+	bool bEnableContactCaching = false;
+
+	/** Distance a particle can slide along or lift off its cached contact before it sweeps again */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "10.0", EditCondition = "bEnableCollision && bEnableContactCaching"))
+	float ContactCacheMargin = 1.f;
+
+	/** How particles are collided with the world. Distance field collision always uses a collision snapshot */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = bEnableCollision))
+	ETetherCollisionMode CollisionMode = ETetherCollisionMode::Sweep;
+
+	/** Distance between samples of the distance field, as a fraction of the collision width. Lower values follow small details more closely, but take longer to bake and use more memory */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.05", UIMax = "1.0", EditCondition = "bEnableCollision && CollisionMode == ETetherCollisionMode::DistanceField"))
+	float DistanceFieldCellScale = 0.5f;
+
 	/**
 	*   Scale to apply to the desired distance between each particle for simulation
 	*   Lower values create more particles, increasing simulation accuracy but also simulation time.
@@ -91,7 +264,83 @@ public:
 	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
 	float ConstraintsEaseInTime = 2.5f;
 
+	/**
+	 * Where to place the particles of a segment when it starts simulating
+	 * Catenary starts hanging cables close to where they will settle, so constraints are not eased in and a much shorter simulation duration may be used
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	ETetherInitialParticlePlacement InitialParticlePlacement = ETetherInitialParticlePlacement::Spline;
+
+	/**
+	 * Skip simulating series of segments that would hang freely between two fixed anchor points, and place their particles on the catenary instead
+	 * Only applies when stiffness is disabled and the anchor points don't use spline tangents, and only if the catenary doesn't intersect anything
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "!bEnableStiffness"))
+	bool bEnableAnalyticSolve = false;
+
+	/**
+	 * When a cable that has already been simulated is modified, start from its previous simulated shape rather than from the guide spline
+	 * The previous particles are resampled along their length and offset to the new anchor points, then only simulated for WarmStartSettleDuration
+	 * Small edits such as nudging a point or adding slack then resolve much faster, but large edits may not have time to settle
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableWarmStart = false;
+
+	/** Time in seconds to simulate a cable that was warm started from its previous shape */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "5.0", EditCondition = bEnableWarmStart))
+	float WarmStartSettleDuration = 1.f;
+
+	/**
+	 * Stop simulating a series of segments before the full simulation duration once it has come to rest
+	 * A series is at rest when no particle moves faster than RestSpeedThreshold and no constraint is stretched more than RestConstraintErrorThreshold, for RestTimeWindow seconds after constraints have eased in
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableRestDetection = false;
+
+	/** Maximum speed of any particle, in units per second, for the cable to be considered at rest */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "10.0", EditCondition = bEnableRestDetection))
+	float RestSpeedThreshold = 1.f;
+
+	/** Maximum error of any constraint between neighbouring particles, as a fraction of the distance between particles, for the cable to be considered at rest */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "0.2", EditCondition = bEnableRestDetection))
+	float RestConstraintErrorThreshold = 0.05f;
+
+	/** Time in seconds the cable must stay at rest before it stops simulating */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "2.0", EditCondition = bEnableRestDetection))
+	float RestTimeWindow = 0.5f;
+
+	/**
+	 * Allow individual particles that have stopped moving, such as those resting on the floor, to sleep
+	 * Sleeping particles are held in place and skip integration and collision, until a constraint with a neighbouring particle pulls on them by more than ParticleWakeThreshold
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableParticleSleeping = false;
+
+	/** Maximum speed of a particle, in units per second, for it to be allowed to sleep */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "10.0", EditCondition = bEnableParticleSleeping))
+	float ParticleSleepSpeedThreshold = 0.5f;
+
+	/** Time in seconds a particle must stay below the sleep speed before it sleeps */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "1.0", EditCondition = bEnableParticleSleeping))
+	float ParticleSleepTime = 0.1f;
+
+	/** Error of a constraint with a sleeping particle, as a fraction of the distance between particles, above which the particle and its neighbours are woken */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0", UIMax = "0.2", EditCondition = bEnableParticleSleeping))
+	float ParticleWakeThreshold = 0.05f;
+
+	/**
+	 * When simulating the entire duration, simulate series of segments between fixed anchor points at the same time on worker threads
+	 * Series only affect each other through self-collision, so this has no effect with self-collision, and otherwise gives the same result as simulating them one after another
+	 */
+	UPROPERTY(Category = "TetherProperties", EditAnywhere, BlueprintReadWrite)
+	bool bEnableParallelSeries = false;
+
 	bool ShouldUseSelfCollision() const;
+	bool ShouldUseCollisionSnapshot() const;
+	bool ShouldUseDistanceField() const;
+	bool ShouldUseCollisionCulling() const;
+	bool ShouldUseContactCaching() const;
+	bool ShouldUseWarmStart(bool bRealtimeSimulating) const;
 	void CheckSelfCollisionOptions() const;
 };
 
@@ -99,14 +348,50 @@ FORCEINLINE uint32 GetTypeHash(const FTetherCableSimulationOptions& InOptions)
 {
 	uint32 Hash = GetTypeHash(InOptions.SimulationDuration);
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.SubstepTime));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableAdaptiveSubstepping));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.MinSubstepTime));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.MaxSubstepTime));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.AdaptiveSubstepMaxTravel));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.AdaptiveSubstepStretchThreshold));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableStiffness));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.StiffnessSolverIterations));
+	Hash = HashCombine(Hash, GetTypeHash((uint8)InOptions.ConstraintSolver));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableLocalSpaceSolver));
+	Hash = HashCombine(Hash, GetTypeHash((uint8)InOptions.Integrator));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ImplicitNewtonIterations));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ImplicitSolverIterations));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ImplicitStretchStiffness));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableTethers));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableCompliance));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.StretchCompliance));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.StiffnessCompliance));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.Drag));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableCollision));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableSelfCollision));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.CollisionWidthScale));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.CollisionFriction));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableCollisionSnapshot));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableBatchedCollisionQueries));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableCollisionCulling));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.CollisionCullingDistance));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableContactCaching));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ContactCacheMargin));
+	Hash = HashCombine(Hash, GetTypeHash((uint8)InOptions.CollisionMode));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.DistanceFieldCellScale));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.ParticleDistanceScale));
 	Hash = HashCombine(Hash, GetTypeHash(InOptions.ConstraintsEaseInTime));
+	Hash = HashCombine(Hash, GetTypeHash((uint8)InOptions.InitialParticlePlacement));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableAnalyticSolve));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableWarmStart));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.WarmStartSettleDuration));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableRestDetection));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.RestSpeedThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.RestConstraintErrorThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.RestTimeWindow));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableParticleSleeping));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ParticleSleepSpeedThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ParticleSleepTime));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.ParticleWakeThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(InOptions.bEnableParallelSeries));
 	return Hash;
 }
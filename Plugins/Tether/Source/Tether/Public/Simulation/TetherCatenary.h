@@ -0,0 +1,39 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * Closed-form shape of a perfectly flexible, inextensible cable hanging between two points under a uniform force
+ */
+struct TETHER_API FTetherCatenary
+{
+	/**
+	 * Solves the catenary of a cable of the given length hanging between two points
+	 * @return	False if there is no catenary, such as when the cable is taut, hangs vertically or there is no force
+	 */
+	static bool Solve(const FVector& Start, const FVector& End, double Length, const FVector& CableForce, FTetherCatenary& OutCatenary);
+
+	/** Location at the given distance along the cable from the start point */
+	FVector GetLocationAtDistance(double Distance) const;
+
+private:
+
+	FVector Start = FVector::ZeroVector;
+
+	// Opposite to the force
+	FVector Up = FVector::UpVector;
+
+	// Horizontal direction from the start point to the end point
+	FVector Across = FVector::ForwardVector;
+
+	// Horizontal scale of the catenary, the ratio of horizontal tension to force per unit length
+	double CatenaryParam = 1.0;
+
+	// Horizontal distance from the start point to the lowest point of the catenary
+	double Vertex = 0.0;
+
+	// Cached terms of the catenary at the start point
+	double StartSinh = 0.0;
+	double StartHeight = 0.0;
+};
@@ -0,0 +1,69 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+
+struct FTetherCollisionSnapshot;
+
+/**
+ * Sparse grid of distances to the collision of a snapshot, sampled once before simulating so particles can be collided with a lookup rather than a sweep
+ * Space is divided into bricks of cells, and only bricks near collision store their samples, so everywhere else is known to be clear without storing anything
+ * Distances to triangles are unsigned, as triangles are two sided and needn't form closed meshes, and distances inside capsules are negative
+ */
+struct TETHER_API FTetherCollisionDistanceField
+{
+	/**
+	 * Samples the distance to the collision of the snapshot within its bounds
+	 * @param	InCellSize		Distance between samples. May be increased to keep the grid of bricks to a reasonable size for very large bounds
+	 * @param	InMaxDistance	Distance from collision beyond which positions are considered clear, which must be more than the radius of anything collided with the field
+	 */
+	void Build(const FTetherCollisionSnapshot& Snapshot, float InCellSize, float InMaxDistance);
+
+	/** If the field was built with the given settings */
+	bool WasBuiltWith(float InCellSize, float InMaxDistance) const { return bValid && RequestedCellSize == InCellSize && MaxDistance == InMaxDistance; }
+
+	/**
+	 * Interpolates the distance to the nearest collision at a position, and the direction away from it
+	 * @param	OutBodyIndex	Index in the snapshot of the body nearest to the closest corner of the cell of the position
+	 * @return	False if the position is clear of collision, or outside the field
+	 */
+	bool Sample(const FVector& Position, float& OutDistance, FVector& OutNormal, int32& OutBodyIndex) const;
+
+	bool IsValid() const { return bValid; }
+
+	float GetCellSize() const { return CellSize; }
+
+	int32 GetNumBricks() const { return NumBricks; }
+
+	int32 GetNumGridBricks() const { return BrickIndices.Num(); }
+
+private:
+
+	int32 GetGridBrickIndex(int32 X, int32 Y, int32 Z) const { return X + NumGridBricks.X * (Y + NumGridBricks.Y * Z); }
+
+	bool bValid = false;
+
+	// Corner of the first cell
+	FVector Origin = FVector::ZeroVector;
+
+	float CellSize = 0.f;
+
+	float RequestedCellSize = 0.f;
+
+	float MaxDistance = 0.f;
+
+	// Number of bricks along each axis
+	FIntVector NumGridBricks = FIntVector::ZeroValue;
+
+	// Number of stored bricks
+	int32 NumBricks = 0;
+
+	// Index of the samples of each brick of the grid, or none if the brick is clear
+	TArray<int32> BrickIndices;
+
+	// Samples at every corner of the cells of each stored brick, so no brick needs its neighbours to be interpolated
+	TArray<float> BrickSamples;
+
+	// Body nearest to each sample, in the same order as the samples
+	TArray<int32> SampleBodies;
+};
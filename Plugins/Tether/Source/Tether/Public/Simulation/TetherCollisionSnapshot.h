@@ -0,0 +1,181 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+#include "TetherCollisionDistanceField.h"
+
+struct FTetherSimulationModel;
+struct FTetherSimulationParams;
+class UBodySetup;
+
+/**
+ * Read-only copy of the collision around a cable, taken on the game thread before it is simulated
+ * The triangles, convexes, boxes, spheres and capsules of every blocking primitive within the bounds are copied into a private bounding volume hierarchy,
+ * so particles can be swept against them from any thread without querying or locking the physics scene, and get the same hits every time
+ * Primitives whose collision can't be copied, such as landscape heightfields, are swept individually instead
+ * A snapshot is never modified once built, so it can be shared by any number of simulations, and reused until the collision around the cable changes
+ */
+struct TETHER_API FTetherCollisionSnapshot
+{
+	/** Bounds that may have to be swept in to simulate the model: the particles of each segment, expanded by the length of the segment and the collision width */
+	static FBox GetSimulationBounds(const FTetherSimulationModel& Model, const FTetherSimulationParams& Params);
+
+	/**
+	 * Copies the collision of every primitive within the bounds that the collision profile of the params responds to, other than triggers and the simulated component itself
+	 * Must be called on the game thread
+	 */
+	void Build(const FTetherSimulationParams& Params, const FBox& InBounds);
+
+	/**
+	 * If the snapshot still matches the world for simulating with the params within the bounds
+	 * False if the bounds go outside the snapshot, the query settings differ, or if any primitive within the snapshot has been added, removed, moved or changed
+	 * Must be called on the game thread
+	 */
+	bool IsUpToDate(const FTetherSimulationParams& Params, const FBox& RequiredBounds) const;
+
+	/** If a sphere of the given radius swept between the two points stays within the snapshot, so sweeping against the snapshot finds every hit the physics scene would */
+	bool Contains(const FVector& Start, const FVector& End, float Radius) const;
+
+	/**
+	 * Sweeps a sphere against the snapshot, adding the first hit with each body to the hits
+	 * Hits that start penetrating are pushed out along the shortest direction out of the primitive, as in sweeps against the physics scene
+	 * @return	True if anything was hit
+	 */
+	bool SweepSphere(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius) const;
+
+	/**
+	 * Sweeps a sphere against only the bodies that couldn't be copied, adding the first hit with each to the hits
+	 * For sweeps whose copied collision has already been handled another way, such as by the distance field
+	 * @return	True if anything was hit
+	 */
+	bool SweepSweptComponents(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius) const;
+
+	/** Adds a triangle to the snapshot, which isn't swept against until the hierarchy is rebuilt */
+	void AddTriangle(const FVector& A, const FVector& B, const FVector& C, int32 BodyIndex, int32 FaceIndex = INDEX_NONE);
+
+	/** Adds a capsule around the segment between two points to the snapshot, or a sphere if the points are the same, which isn't swept against until the hierarchy is rebuilt */
+	void AddCapsule(const FVector& A, const FVector& B, float Radius, int32 BodyIndex);
+
+	/** Builds the bounding volume hierarchy over every triangle and capsule that has been added */
+	void BuildHierarchy();
+
+	/** Samples the distance field of the copied primitives, which must be done before the snapshot is shared with any simulation */
+	void BuildDistanceField(float CellSize, float MaxDistance);
+
+	const FTetherCollisionDistanceField& GetDistanceField() const { return DistanceField; }
+
+	/** Adds the index of every primitive whose bounds intersect the box */
+	void GetPrimitivesInBox(const FBox& Box, TArray<int32>& OutPrimitives) const;
+
+	/**
+	 * Distance from the point to the nearest collision in the snapshot, up to the given maximum
+	 * Bodies that are swept individually are measured to their bounds, so the distance never overestimates
+	 */
+	float GetDistanceToNearest(const FVector& Point, float MaxDistance) const;
+
+	/** Distance from the point to the surface of a primitive, which is negative inside capsules */
+	float GetPrimitiveDistance(int32 PrimitiveIndex, const FVector& Point) const;
+
+	FBox GetPrimitiveBounds(int32 PrimitiveIndex) const { return Primitives[PrimitiveIndex].GetBounds(); }
+
+	int32 GetPrimitiveBodyIndex(int32 PrimitiveIndex) const { return Primitives[PrimitiveIndex].BodyIndex; }
+
+	/** Component that collision of a body was copied from, if any */
+	TWeakObjectPtr<UPrimitiveComponent> GetBodyComponent(int32 BodyIndex) const { return Bodies.IsValidIndex(BodyIndex) ? Bodies[BodyIndex].Component : nullptr; }
+
+	bool IsValid() const { return bValid; }
+
+	const FBox& GetBounds() const { return Bounds; }
+
+	int32 GetNumPrimitives() const { return Primitives.Num(); }
+
+	int32 GetNumBodies() const { return Bodies.Num(); }
+
+	/** If any bodies couldn't be copied, so they are missing from the distance field and must still be swept */
+	bool HasSweptComponents() const { return SweptComponentBodies.Num() > 0; }
+
+private:
+
+	/** Primitive component that collision was copied from */
+	struct FBody
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UBodySetup> BodySetup;
+
+		// Item of the component, such as the instance of an instanced static mesh
+		int32 Item = INDEX_NONE;
+
+		FTransform Transform;
+		FBoxSphereBounds ComponentBounds;
+
+		// If the collision of the component couldn't be copied, so it is swept individually
+		bool bSweepComponent = false;
+	};
+
+	/** A triangle, or a capsule around the segment from A to B */
+	struct FPrimitive
+	{
+		FVector A;
+		FVector B;
+		FVector C;
+		float Radius = 0.f;
+		int32 BodyIndex = INDEX_NONE;
+		int32 FaceIndex = INDEX_NONE;
+		bool bTriangle = false;
+
+		FBox GetBounds() const;
+	};
+
+	/** Node of the hierarchy, with two children if it has no primitives */
+	struct FNode
+	{
+		FBox Bounds;
+
+		// Index of the first child node, or of the first primitive of a leaf
+		int32 FirstIndex = 0;
+
+		// Number of primitives of a leaf, or zero if the node has children
+		int32 NumPrimitives = 0;
+	};
+
+	/** Copies the collision of a body, returning false if it has collision that can't be copied */
+	bool AddBodyCollision(const FBody& Body, int32 BodyIndex);
+
+	int32 BuildNode(int32 Begin, int32 End);
+
+	/** Earliest time along the sweep that the sphere touches the primitive, filling in the hit, or false if it doesn't */
+	bool SweepPrimitive(const FPrimitive& Primitive, const FVector& Start, const FVector& Delta, float Radius, FHitResult& OutHit) const;
+
+	/** Sweeps the components of the bodies that couldn't be copied and whose bounds intersect the sweep bounds, adding any hits */
+	void SweepComponents(TArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius, const FBox& SweepBounds) const;
+
+	/** Fills in the parts of a hit that come from the sweep and the body that was hit */
+	void FillHit(FHitResult& Hit, int32 BodyIndex, const FVector& Start, const FVector& End) const;
+
+	/** Hash of the query settings of the params that decide which primitives are copied */
+	static uint32 GetQueryHash(const FTetherSimulationParams& Params);
+
+	bool bValid = false;
+
+	FBox Bounds = FBox(ForceInit);
+
+	uint32 QueryHash = 0;
+
+	TArray<FBody> Bodies;
+
+	TArray<FPrimitive> Primitives;
+
+	TArray<FNode> Nodes;
+
+	// Indices of the bodies that are swept individually
+	TArray<int32> SweptComponentBodies;
+
+	// Settings to sweep individual components with
+	ECollisionChannel TraceChannel = ECC_PhysicsBody;
+	bool bTraceComplex = false;
+
+	FTetherCollisionDistanceField DistanceField;
+};
@@ -7,6 +7,8 @@
 
 class FProgressCancel;
 struct FTetherSimulationContext;
+struct FTetherSimulationParticleStore;
+struct FTetherSimulationScratch;
 struct FTetherSimulationSubstepContext;
 struct FTetherSimulationSegment;
 struct FTetherSimulationModel;
@@ -24,14 +26,129 @@ public:
 	 */
 	static FTetherSimulationResultInfo PerformSimulation(FTetherSimulationModel& Model, float SimulationTime, const FTetherSimulationParams& Params, FProgressCancel* Progress = nullptr);
 
+	/**
+	 * Simulate the specified model for the specified amount of time, in the given particle store and scratch
+	 * Keeping the store and scratch between simulations of the same cable, such as each tick of a realtime simulation, lets them reuse their allocations
+	 */
+	static FTetherSimulationResultInfo PerformSimulation(FTetherSimulationModel& Model, float SimulationTime, const FTetherSimulationParams& Params, FTetherSimulationParticleStore& ParticleStore, FTetherSimulationScratch& Scratch, FProgressCancel* Progress = nullptr);
+
+	/**
+	 * Simulate many models together for the specified amount of time, giving the same result for each as simulating it alone
+	 * Models that share their substep time, cable force, drag, integrator, solver and substep features are grouped, and the particles of each group are packed into one store
+	 * Each substep of a group integrates the particles of every model in one pass over the store, then solves the constraint programs of every model in one pass, before colliding each model
+	 * Models that use self-collision or adaptive substeps, or that share their substeps with no other model, are simulated alone
+	 * @param	Params	Params of each model
+	 * @param	SimulationTime	Time in seconds to simulate. If zero, simulate the entire maximum duration in the params of each model.
+	 * @return	Result of each model
+	 */
+	static TArray<FTetherSimulationResultInfo> PerformBatchSimulation(TArrayView<FTetherSimulationModel*> Models, TArrayView<const FTetherSimulationParams*> Params, float SimulationTime, FProgressCancel* Progress = nullptr);
+
 private:
 
-	static void PerformSimulationSubstep(FTetherSimulationContext& SimulationContext, TArray<FTetherProxySimulationSegmentSeries> SegmentsToSimulate, float SubstepTime, int32 SubstepNum);
+	/**
+	 * Features that a substep is compiled with, combined as flags
+	 * Each series is simulated with a substep specialised for the features it uses, so unused features cost nothing in the inner loops
+	 */
+	enum ESubstepFeatures : uint32
+	{
+		SubstepFeature_None = 0,
+		SubstepFeature_Collision = 1 << 0,
+		SubstepFeature_SelfCollision = 1 << 1,
+		// Debug logging, console variables, per particle profiling scopes and ensures
+		SubstepFeature_Debug = 1 << 2,
+		SubstepFeature_NumCombinations = 1 << 3
+	};
+
+	// Table of substeps specialised for every combination of features
+	template<typename FeatureCombinationSequence>
+	struct TSubstepTable;
+
+	/** The series of one model of a batch taking its next substep, together with the series of the other models of the batch */
+	struct FBatchSeriesSubstep
+	{
+		FTetherSimulationContext* SimulationContext = nullptr;
+		FTetherProxySimulationSegmentSeries* Series = nullptr;
+		int32 SubstepNum = 0;
+	};
+
+	/** Whether the model can be simulated in a batch with other models, rather than alone */
+	static bool CanSimulateInBatch(const FTetherSimulationParams& Params);
+
+	/** Whether two models can take their substeps together in a batch, integrating their particles in one pass and specialising their substeps for the same features */
+	static bool CanShareBatchSubsteps(const FTetherSimulationParams& A, const FTetherSimulationParams& B);
+
+	/** Makes the series of the model to simulate, bound to the model's particles which must already be in the particle store, and solves any that can be solved in closed form */
+	static void BeginSimulation(FTetherSimulationContext& SimulationContext, float SimulationTime, TArray<FTetherProxySimulationSegmentSeries>& OutSegmentsToSimulate);
+
+	/** Writes the simulated particles back to the model and fills in the rest of the result */
+	static void EndSimulation(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SimulatedSeries, float SimulationTime, float SimulationTimeRemainder);
+
+	/** Shortest substep a series may be simulated with */
+	static float GetMinSubstepTime(const FTetherSimulationParams& Params);
+
+	/** Compiles the constraints of the given series into the program its substeps are solved with */
+	static void BuildConstraintProgram(const FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series);
+
+	/** Features needed to simulate the given series, which are chosen once per series when the simulation begins */
+	static uint32 GetSubstepFeatures(const FTetherSimulationContext& SimulationContext, const FTetherProxySimulationSegmentSeries& Series);
+
+	template<uint32 Features>
+	static void PerformSimulationSubstep(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SegmentsToSimulate, float SubstepTime, int32 SubstepNum);
+
+	/**
+	 * Takes one substep of the given series of the models of a batch at the same time, which must all share their substeps
+	 * The particles of every series are integrated in one pass, and the constraint programs of every series are solved in one pass
+	 */
+	template<uint32 Features>
+	static void PerformBatchSubstep(TArrayView<FBatchSeriesSubstep> SeriesSubsteps, float SubstepTime);
+
+	/** Integrates the particles [FirstParticle, EndParticle) of the store under the cable force, which may span the series of several models of a batch */
+	static void IntegrateParticles(FTetherSimulationParticleStore& ParticleStore, int32 FirstParticle, int32 EndParticle, const FVector& ForceStep, float Drag, bool bSkipInactiveParticles);
 
 	static void VerletIntegrateSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float SubstepTime);
 
+	/**
+	 * Corrects the explicit prediction of the particles of a series with backward Euler, treating the links between neighbouring particles as stiff springs
+	 * Must follow Verlet integration of the series, which leaves the prediction in the positions and the previous positions in the old positions
+	 */
+	static void ImplicitIntegrateSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float SubstepTime, float ForceMultiplier);
+
+	template<uint32 Features>
 	static void SolveConstraintsForSegment(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& Segment, float ForceMultiplier);
 
+	template<uint32 Features>
 	static void PerformCollision(FTetherSimulationSubstepContext& SubstepContext, FTetherProxySimulationSegmentSeries& SimulatingSegmentSeries, float ForceMultiplier);
+
+	/**
+	 * Chooses the time of the next substep of a series, unless the series has settled or has no simulation time left
+	 * @param	OutSubstepTime	Time of the substep to take
+	 * @return	False if the series has finished simulating
+	 */
+	static bool BeginSeriesSubstep(FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series, int32 SeriesIndex, bool bSimulateEntirely, float SimulationTimeRemainder, float& OutSubstepTime);
+
+	/**
+	 * Simulates the next substep of a series, unless the series has settled or has no simulation time left
+	 * @param	SimulationTimeRemainder	Time left to simulate, reduced by the time of the substep
+	 * @return	False if the series has finished simulating
+	 */
+	static bool SimulateSeriesSubstep(FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series, int32 SeriesIndex, int32 SubstepNum, bool bSimulateEntirely, float& SimulationTimeRemainder);
+
+	/** Simulates the entire duration of each series at the same time on the task graph, which is only valid when series don't self-collide */
+	static void SimulateSeriesInParallel(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SeriesToSimulate, FProgressCancel* Progress);
+
+	/**
+	 * Chooses the time of the next substep for a series from the current state of its particles, so the sequence of substeps is deterministic
+	 * The substep is limited by how far the fastest particle would travel relative to the collision width, and by how stretched the constraints are
+	 */
+	static float ComputeAdaptiveSubstepTime(const FTetherSimulationContext& SimulationContext, const FTetherProxySimulationSegmentSeries& Series);
+
+	/**
+	 * Places the particles of a series that hangs freely between two fixed anchor points on its catenary, if the catenary doesn't intersect anything
+	 * @return	True if the series was solved and doesn't need to be simulated
+	 */
+	static bool SolveSeriesAnalytically(FTetherSimulationContext& SimulationContext, FTetherProxySimulationSegmentSeries& Series);
+
+	/** Copies simulated particles from the particle store back into the segments of the model */
+	static void WriteParticlesToModel(FTetherSimulationContext& SimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> SimulatedSeries);
 	
 };
@@ -0,0 +1,122 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "Misc/EngineVersionComparison.h"
+
+struct FTetherSimulationParticleStore;
+
+// Single precision vector, which local space positions are solved with
+#if UE_VERSION_OLDER_THAN(5,0,0)
+typedef FVector FTetherVector3f;
+#else
+typedef FVector3f FTetherVector3f;
+#endif
+
+/**
+ * Structure-of-arrays list of distance constraints between particles of a constraint program's chain
+ */
+struct TETHER_API FTetherSimulationConstraintList
+{
+	/** Index in the chain of the first particle of each constraint */
+	TArray<int32> IndicesA;
+
+	/** Index in the chain of the second particle of each constraint */
+	TArray<int32> IndicesB;
+
+	/** Distance each constraint holds its particles apart */
+	TArray<float> RestLengths;
+
+	/** Inverse mass of the first and second particle of each constraint, zero if the particle doesn't move */
+	TArray<float> InverseMassesA;
+	TArray<float> InverseMassesB;
+
+	int32 Num() const { return IndicesA.Num(); }
+
+	void Reset();
+
+	void Add(int32 IndexA, int32 IndexB, float RestLength);
+
+	/** Copies the inverse masses of the chain into each constraint */
+	void UpdateInverseMasses(const TArray<float>& ChainInverseMasses);
+};
+
+/**
+ * Flat program of the constraints of a series, compiled once at the start of a simulation so that solvers can run over it without working out which particles each constraint connects
+ * Constraints act on a chain of particles: the synthetic start tangent particle if there is one, then the particles of the series, then the synthetic end tangent particle
+ * Synthetic tangent particles are materialised in the chain as fixed particles with zero inverse mass, so constraints against them need no special handling
+ */
+struct TETHER_API FTetherSimulationConstraintProgram
+{
+	/** Index in the particle store of the first particle of the series */
+	int32 ParticleStoreOffset = 0;
+
+	/** Number of particles of the series in the particle store */
+	int32 ParticleStoreNum = 0;
+
+	/** If the chain starts with a synthetic particle fixed along the start tangent */
+	bool bSyntheticStart = false;
+
+	/** If the chain ends with a synthetic particle fixed along the end tangent */
+	bool bSyntheticEnd = false;
+
+	/** Offset of the synthetic start particle from the first particle of the series */
+	FVector SyntheticStartOffset = FVector::ZeroVector;
+
+	/** Offset of the synthetic end particle from the last particle of the series */
+	FVector SyntheticEndOffset = FVector::ZeroVector;
+
+	/** World position that local space chain positions are relative to, the position of the first particle of the series when the program was compiled */
+	FVector LocalOrigin = FVector::ZeroVector;
+
+	/** Inverse mass of each particle of the chain, as of the last time they were updated */
+	TArray<float> ChainInverseMasses;
+
+	/** Stretch constraints along the chain in order, followed by stiffness constraints along the chain in order */
+	FTetherSimulationConstraintList Constraints;
+
+	int32 NumStretchConstraints = 0;
+
+	/**
+	 * The same constraints, reordered into colours of constraints that share no particles, so each colour can be solved in any order
+	 * Stretch colours come before stiffness colours
+	 */
+	FTetherSimulationConstraintList ColouredConstraints;
+
+	/** Index in the coloured constraints of the first constraint of each colour, followed by the total number of constraints */
+	TArray<int32> ColourOffsets;
+
+	/** Index in the chain of each tethered particle, and of the anchor it is tethered to */
+	TArray<int32> TetherParticles;
+	TArray<int32> TetherAnchors;
+
+	/** Maximum distance of each tethered particle from its anchor */
+	TArray<float> TetherLengths;
+
+	/**
+	 * Compiles the constraints of a series of particles in the particle store
+	 * @param	StartTangent	Tangent to hold the start of the series along, or null if the start is free to rotate
+	 * @param	EndTangent		Tangent to hold the end of the series along, or null if the end is free to rotate
+	 * @param	AnchorIndices	Index in the particle store of the anchor of each particle of the series, or null for no tethers
+	 */
+	void Build(const FTetherSimulationParticleStore& ParticleStore, int32 InParticleStoreOffset, int32 InParticleStoreNum, float ParticleSegmentLength, bool bEnableStiffness, const FVector* StartTangent, const FVector* EndTangent, const TArray<int32>* AnchorIndices);
+
+	int32 GetNumChainParticles() const { return ChainInverseMasses.Num(); }
+
+	int32 GetNumColours() const { return ColourOffsets.Num() - 1; }
+
+	/** Brings the inverse masses of the program up to date with the particle store, such as when particles have started or stopped sleeping */
+	void UpdateInverseMasses(const FTetherSimulationParticleStore& ParticleStore);
+
+	/** Copies the positions of the particles of the series out of the store into the chain, and places the synthetic particles */
+	void GatherPositions(const FTetherSimulationParticleStore& ParticleStore, TArray<FVector>& OutChainPositions) const;
+
+	/** Copies the positions of the particles of the series from the chain back into the store */
+	void ScatterPositions(const TArray<FVector>& ChainPositions, FTetherSimulationParticleStore& ParticleStore) const;
+
+	/** Copies the positions of the particles of the series out of the store into the chain in single precision relative to the local origin, and places the synthetic particles */
+	void GatherLocalPositions(const FTetherSimulationParticleStore& ParticleStore, TArray<FTetherVector3f>& OutChainPositions) const;
+
+	/** Copies the positions of the free particles of the series from the local space chain back into the store, leaving fixed and sleeping particles exactly where they were */
+	void ScatterLocalPositions(const TArray<FTetherVector3f>& ChainPositions, FTetherSimulationParticleStore& ParticleStore) const;
+};
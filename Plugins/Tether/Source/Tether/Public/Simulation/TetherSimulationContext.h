@@ -2,22 +2,104 @@
 
 #pragma once
 #include "CoreMinimal.h"
+#include "TetherSimulationConstraintProgram.h"
+#include "TetherSimulationParticleStore.h"
 #include "TetherSimulationSegmentSeries.h"
+#include "Engine/EngineTypes.h"
+#include "Misc/EngineVersionComparison.h"
+#if UE_VERSION_OLDER_THAN(5,2,0)
+#include "WorldCollision.h"
+#else
+#include "Engine/OverlapResult.h"
+#endif
 
 struct FTetherSimulationResultInfo;
 struct FTetherSimulationModel;
 struct FTetherSimulationParams;
 
+/** A body found by the overlap of a series, to sweep its particles against individually */
+struct FTetherSimulationCollisionCandidate
+{
+	FBodyInstance* BodyInstance = nullptr;
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	TWeakObjectPtr<AActor> Actor;
+	int32 Item = INDEX_NONE;
+
+	// World bounds of the body, to skip sweeps that can't touch it
+	FBox Bounds;
+};
+
+/**
+ * Temporaries used by substeps, owned by a simulation for its whole run so that substeps don't allocate
+ * Buffers are reserved for the largest series up front, and are only ever reset rather than freed
+ */
+struct FTetherSimulationScratch
+{
+	// Positions of the chain of particles of the constraint program currently being solved
+	TArray<FVector> ChainPositions;
+
+	// Accumulated Lagrange multipliers of the compliant constraints of the program currently being solved
+	TArray<float> ConstraintLambdas;
+
+	// The direct solver's tridiagonal system of stretch constraints
+	TArray<FVector> ChainConstraintDirections;
+	TArray<float> ChainSystemDiagonal;
+	TArray<float> ChainSystemUpper;
+	TArray<float> ChainSystemRhs;
+
+	// The same chain positions and constraint directions, in single precision relative to the local origin of the program, when solving in local space
+	TArray<FTetherVector3f> LocalChainPositions;
+	TArray<FTetherVector3f> LocalChainConstraintDirections;
+
+	// The implicit integrator's displacement from the prediction, Newton step, conjugate gradient vectors and spring Hessians, per particle and per spring of the series being integrated
+	TArray<FVector> ImplicitDisplacement;
+	TArray<FVector> ImplicitStep;
+	TArray<FVector> ImplicitResidual;
+	TArray<FVector> ImplicitDirection;
+	TArray<FVector> ImplicitProduct;
+	TArray<FVector> ImplicitSpringDirections;
+	TArray<float> ImplicitSpringAxialStiffness;
+	TArray<float> ImplicitSpringLateralStiffness;
+
+	// Positions along the catenary of the series currently being solved analytically
+	TArray<FVector> CatenaryPositions;
+
+	// Hits of the sweep of the particle currently colliding
+	TArray<FHitResult> CollisionHits;
+
+	// Overlaps of the series currently colliding, and the bodies they were resolved to, when batching collision queries
+	TArray<FOverlapResult> CollisionOverlaps;
+	TArray<FTetherSimulationCollisionCandidate> CollisionCandidates;
+
+	/** Reserves the temporaries needed to simulate each of the given series, which must have built their constraint programs */
+	void Reserve(TArrayView<const FTetherProxySimulationSegmentSeries> SeriesToSimulate);
+
+	/** Total bytes allocated by the temporaries, so tests can check substeps never grow them */
+	SIZE_T GetAllocatedSize() const;
+};
+
 struct FTetherSimulationContext
 {	
 	FTetherSimulationModel& Model;
 	const FTetherSimulationParams& Params;
 	FTetherSimulationResultInfo& ResultInfo;
 
-	FTetherSimulationContext(FTetherSimulationModel& InModel, const FTetherSimulationParams& InParams, FTetherSimulationResultInfo& InResultInfo)
+	// Particles of the model being simulated, which are written back to the model segments when the simulation finishes
+	// Shared by the contexts of series simulating in parallel
+	FTetherSimulationParticleStore& ParticleStore;
+
+	// Index of the model in the particle store, which holds several models when simulating a batch
+	int32 ParticleStoreModelIndex = 0;
+
+	// Temporaries of the substeps, reused between series and substeps, and between models when simulating a batch
+	FTetherSimulationScratch& Scratch;
+
+	FTetherSimulationContext(FTetherSimulationModel& InModel, const FTetherSimulationParams& InParams, FTetherSimulationResultInfo& InResultInfo, FTetherSimulationParticleStore& InParticleStore, FTetherSimulationScratch& InScratch)
 		: Model(InModel)
 		, Params(InParams)
 		, ResultInfo(InResultInfo)
+		, ParticleStore(InParticleStore)
+		, Scratch(InScratch)
 	{
 	}
 };
@@ -26,9 +108,10 @@ struct FTetherSimulationSubstepContext
 {	
 	FTetherSimulationContext& SimulationContext;
 	int32 SubstepNum = -1;
-	TArray<FTetherProxySimulationSegmentSeries>& SegmentsToSimulate;
+	float SubstepTime = 0.f;
+	TArrayView<FTetherProxySimulationSegmentSeries> SegmentsToSimulate;
 
-	FTetherSimulationSubstepContext(FTetherSimulationContext& InSimulationContext, TArray<FTetherProxySimulationSegmentSeries>& InSegmentsToSimulate)
+	FTetherSimulationSubstepContext(FTetherSimulationContext& InSimulationContext, TArrayView<FTetherProxySimulationSegmentSeries> InSegmentsToSimulate)
 		: SimulationContext(InSimulationContext)
 		, SegmentsToSimulate(InSegmentsToSimulate)
 	{
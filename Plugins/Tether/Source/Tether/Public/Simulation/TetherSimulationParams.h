@@ -10,6 +10,7 @@
 #include "PhysicsEngine/BodyInstance.h"
 #include "TetherSimulationParams.generated.h"
 
+struct FTetherCollisionSnapshot;
 struct FTetherSimulationModel;
 
 USTRUCT()
@@ -75,6 +76,9 @@ struct TETHER_API FTetherSimulationParams
 
 	TArray<FBodyInstance*> BodyInstances;
 
+	// Copy of the collision around the cable to sweep against instead of the world, if enabled
+	TSharedPtr<const FTetherCollisionSnapshot, ESPMode::ThreadSafe> CollisionSnapshot;
+
 	// Note: Be careful about accessing the owning actor and component on the worker thread
 	// They may be destroyed on the main thread while the simulation is running
 	TWeakObjectPtr<const AActor> OwningActor;
@@ -0,0 +1,153 @@
+// Copyright Sam Bonifacio 2021. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTetherSimulationModel;
+struct FTetherSimulationParticle;
+struct FTetherSimulationSegment;
+
+/**
+ * Mutable reference to a single particle, either held in a particle store or standalone (e.g. synthetic tangent particles)
+ */
+struct FTetherSimulationParticleRef
+{
+	FTetherSimulationParticleRef(FVector& InPosition, FVector& InOldPosition, bool bInFree, uint32 InParticleUniqueId)
+		: Position(InPosition)
+		, OldPosition(InOldPosition)
+		, bFree(bInFree)
+		, ParticleUniqueId(InParticleUniqueId)
+	{
+	}
+
+	FVector& Position;
+	FVector& OldPosition;
+	bool bFree;
+	uint32 ParticleUniqueId;
+};
+
+/**
+ * Contiguous structure-of-arrays storage for the particles of every segment of a simulation model, used while simulating
+ * Joining particles shared by consecutive segments are only stored once, so segments are overlapping index ranges into the store
+ * Particle indices in the store match the particle indices of the model when not including duplicates
+ * Several models can be packed one after another into the same store to simulate them as a batch, in which case only the first model's indices match
+ */
+struct TETHER_API FTetherSimulationParticleStore
+{
+	/** Current position of each particle */
+	TArray<FVector> Positions;
+
+	/** Position of each particle on the previous iteration */
+	TArray<FVector> OldPositions;
+
+	/** Inverse mass of each particle, 1 if the particle is free (simulating) or 0 if fixed to something or sleeping */
+	TArray<float> InverseMasses;
+
+	/** If each particle is free but sleeping, so is treated as fixed in place until it is woken */
+	TArray<bool> Sleeping;
+
+	/** Time in seconds each particle has continuously been moving slowly enough to sleep */
+	TArray<float> StillTimes;
+
+	TArray<uint32> ParticleUniqueIds;
+
+	/** Position each particle was last measured to be clear of collision around, when culling collision, or empty if not culling */
+	TArray<FVector> ClearCentres;
+
+	/** Distance each particle can move from its clear centre without touching any collision, or 0 if it isn't known to be clear */
+	TArray<float> ClearRadii;
+
+	/** Substep before which each particle shouldn't measure its clearance again, after it was last found not to be clear */
+	TArray<int32> NextClearanceSubsteps;
+
+	/** Plane of the surface each particle last hit, or a zero plane if the particle has no cached contact, or empty if not caching contacts */
+	TArray<FPlane> ContactPlanes;
+
+	/** Position each particle was resolved to when its contact was cached */
+	TArray<FVector> ContactAnchors;
+
+	/** Component each particle's cached contact belongs to, if any */
+	TArray<TWeakObjectPtr<class UPrimitiveComponent>> ContactComponents;
+
+	bool HasCachedContact(int32 Index) const { return !ContactPlanes[Index].GetNormal().IsZero(); }
+
+	/** Index in the store of the first particle of each segment of each model */
+	TArray<int32> SegmentOffsets;
+
+	/** Number of particles of each segment of each model, including the joining particle */
+	TArray<int32> SegmentNumParticles;
+
+	/** Index of the first segment containing each particle */
+	TArray<int32> ParticleSegments;
+
+	/** Index in the segment arrays of the first segment of each model packed into the store */
+	TArray<int32> ModelSegmentOffsets;
+
+	/** Copies the particles of all segments of the model into the store, replacing anything already in it */
+	void Build(const FTetherSimulationModel& Model);
+
+	/** Reserves space for the given total number of particles, segments and models, to append several models without reallocating */
+	void Reserve(int32 NumParticles, int32 NumSegments, int32 NumModels);
+
+	/**
+	 * Copies the particles of all segments of the model into the store after any models already in it
+	 * @return	Index of the model in the store
+	 */
+	int32 Append(const FTetherSimulationModel& Model);
+
+	/**
+	 * Sizes the collision culling and contact caching arrays to the particles in the store, with nothing known about any particle, or empties them if unused
+	 * Called once every model is in the store, as the arrays aren't filled in by Build or Append
+	 */
+	void InitCollisionCaches(bool bClearances, bool bContacts);
+
+	/** Total bytes allocated by the store's arrays, so tests can check simulating never grows them */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Copies the particles of the given segment of the given model back out of the store */
+	void WriteToSegment(FTetherSimulationSegment& Segment, int32 ModelIndex = 0) const;
+
+	int32 Num() const { return Positions.Num(); }
+
+	bool IsValidIndex(int32 Index) const { return Positions.IsValidIndex(Index); }
+
+	bool IsFree(int32 Index) const { return InverseMasses[Index] > 0.f; }
+
+	bool IsSleeping(int32 Index) const { return Sleeping[Index]; }
+
+	/** Puts a free particle to sleep, holding it in place, or wakes a sleeping particle */
+	void SetSleeping(int32 Index, bool bSleep);
+
+	FTetherSimulationParticleRef GetParticleRef(int32 Index)
+	{
+		return FTetherSimulationParticleRef(Positions[Index], OldPositions[Index], IsFree(Index), ParticleUniqueIds[Index]);
+	}
+
+	/** Makes a standalone copy of the particle at the given index */
+	FTetherSimulationParticle MakeParticle(int32 Index) const;
+
+	/** Index in the segment arrays of the segment with the given unique ID in the given model */
+	int32 GetSegmentIndex(int32 ModelIndex, int32 SegmentUniqueId) const { return ModelSegmentOffsets[ModelIndex] + SegmentUniqueId; }
+
+	/** Index of the last particle of the given segment, plus one */
+	int32 GetSegmentEnd(int32 SegmentIndex) const { return SegmentOffsets[SegmentIndex] + SegmentNumParticles[SegmentIndex]; }
+
+	/** Index of the first segment containing the given particle */
+	int32 FindSegmentWithParticle(int32 Index) const { return ParticleSegments[Index]; }
+
+	/** Finds the index in the store of the particle with the given unique ID, or INDEX_NONE */
+	int32 FindParticleUniqueId(uint32 ParticleUniqueId) const;
+};
+
+FORCEINLINE uint32 GetTypeHash(const FTetherSimulationParticleStore& InStore)
+{
+	uint32 Hash = GetTypeHash(InStore.Num());
+	for(int32 i = 0; i < InStore.Num(); i++)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(InStore.InverseMasses[i] > 0.f));
+		Hash = HashCombine(Hash, GetTypeHash(InStore.Positions[i]));
+		Hash = HashCombine(Hash, GetTypeHash(InStore.OldPositions[i]));
+	}
+	return Hash;
+}
@@ -18,6 +18,26 @@ struct TETHER_API FTetherSimulationResultInfo
 	 */
 	TArray<int32> SimulatedSegments;
 
+	/**
+	 * Indices of cable segments whose result was solved in closed form rather than simulated, a subset of SimulatedSegments
+	 */
+	TArray<int32> AnalyticSegments;
+
+	/**
+	 * True if every simulated segment was solved in closed form, so nothing was actually simulated
+	 */
+	bool bAnalytic = false;
+
+	/**
+	 * True if series of segments were simulated at the same time on worker threads
+	 */
+	bool bParallelSeries = false;
+
+	/**
+	 * True if the model was simulated in a batch, integrating and solving its particles together with other models
+	 */
+	bool bBatched = false;
+
 	/**
 	 * Time that was actually simulated
 	 */ 
@@ -38,4 +58,35 @@ struct TETHER_API FTetherSimulationResultInfo
 	 * Useful for debugging simulation determinism
 	 */
 	int32 NumCollisionHits = 0;
+
+	/**
+	 * Number of particle collision sweeps performed, and the number skipped because the particle was known to be clear of collision
+	 */
+	int32 NumCollisionSweeps = 0;
+	int32 NumCulledCollisionSweeps = 0;
+
+	/**
+	 * Number of collision hits resolved against a particle's cached contact rather than found by a sweep
+	 */
+	int32 NumCachedContactHits = 0;
+
+	/**
+	 * Number of substeps performed across all segment series
+	 */
+	int32 NumSubsteps = 0;
+
+	/**
+	 * Number of segment series that came to rest and stopped simulating before the full simulation duration
+	 */
+	int32 NumSettledSeries = 0;
+
+	/**
+	 * Simulation time at which the last settled series came to rest, or zero if no series settled
+	 */
+	float SettledTime = 0.f;
+
+	/**
+	 * Number of particles that were asleep when the simulation finished
+	 */
+	int32 NumSleepingParticles = 0;
 };
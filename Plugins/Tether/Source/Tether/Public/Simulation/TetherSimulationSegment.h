@@ -69,6 +69,10 @@ struct TETHER_API FTetherSimulationSegment
 	UPROPERTY()
 	float SimulationTime = 0.f;
 
+	// Time in seconds the segment has continuously been at rest while simulating
+	UPROPERTY()
+	float RestTime = 0.f;
+
 	int32 GetNumParticles() const { return Particles.Num(); }
 
 	int32 GetNumParticleSegments() const { return GetNumParticles() - 1; }
@@ -86,6 +90,20 @@ struct TETHER_API FTetherSimulationSegment
 
 	void BuildParticles(float ParticleSegmentLength, bool bStartFixed = true, bool bEndFixed = true);
 
+	/**
+	 * Moves the current particles onto the shape of a previous set of particles for this segment
+	 * Particles are placed at the same fraction of the previous cable's length, then offset by a blend of how far each end of the segment has moved
+	 * @return	False if there are no previous particles to resample
+	 */
+	bool ResampleParticles(const TArray<FTetherSimulationParticle>& PreviousParticles);
+
+	/**
+	 * Moves the current particles onto the catenary that the segment would hang in between its end points under CableForce
+	 * Particles are spaced evenly along the segment's length
+	 * @return	False if there is no catenary to place the particles on, such as when the segment is taut, hangs vertically or there is no force, in which case the particles are unchanged
+	 */
+	bool PlaceParticlesOnCatenary(const FVector& CableForce);
+
 private:
 
 	// Is the segment invalid and in need of being resimulated
@@ -5,6 +5,37 @@
 #include "TetherSimulationSegment.h"
 #include "TetherSimulationSegmentSeries.generated.h"
 
+struct FTetherCableSimulationOptions;
+struct FTetherSimulationParticleStore;
+struct FTetherSimulationConstraintProgram;
+
+/*
+ * Prefix table of particle offsets for the segments of a series, allowing particle lookups in constant time
+ */
+struct FTetherSimulationSegmentSeriesParticleOffsets
+{
+    // Index of the first particle of each segment not including duplicates, followed by the total number of particles
+    TArray<int32> ParticleOffsets;
+
+    // Index of the first particle of each segment including duplicates, followed by the total number of particles
+    TArray<int32> DuplicateParticleOffsets;
+
+    // Index of the first segment containing each particle, not including duplicates
+    TArray<int32> ParticleSegments;
+
+    // Index of the segment containing each particle, including duplicates
+    TArray<int32> DuplicateParticleSegments;
+};
+
+/*
+ * Long-range attachment (tether) constraints of a series, which stop each free particle moving further from its nearest fixed anchor particle than the length of cable between them
+ */
+struct FTetherSimulationSegmentSeriesTethers
+{
+    // Index in the particle store of the anchor each particle of the series is tethered to, or INDEX_NONE if it has no anchor
+    TArray<int32> AnchorIndices;
+};
+
 /*
  * Interface to refer to and operate on a series of one or more connected cable segments, as if they were a single segment
  * It's assumed that the first particle of each segment contained shares the location of the last particle of the previous segment, thus effectively being joined
@@ -65,8 +96,25 @@ struct TETHER_API FTetherSimulationSegmentSeries
 
     float GetSimulatedTime() const;
 
+    void SetRestTime(float RestTime);
+
+    float GetRestTime() const;
+
     virtual bool IsValid() const;
 
+    /*
+     * Caches particle offsets of the contained segments so that particle lookups are constant time rather than scanning every segment
+     * Must be called again if segments are added or removed, or particles of the contained segments are rebuilt
+     */
+    void CacheParticleOffsets();
+    void ResetParticleOffsets();
+    bool HasCachedParticleOffsets() const { return CachedParticleOffsets.IsValid(); }
+
+private:
+
+    // Shared so that copying a series stays cheap
+    TSharedPtr<const FTetherSimulationSegmentSeriesParticleOffsets> CachedParticleOffsets;
+
 };
 
 /**
@@ -82,7 +130,65 @@ struct TETHER_API FTetherProxySimulationSegmentSeries : public FTetherSimulation
     */ 
     TArray<FTetherSimulationSegment*> Segments;
 
+    /*
+    * Particle store this series is a view over while simulating, if bound
+    */
+    FTetherSimulationParticleStore* ParticleStore = nullptr;
+
+    // Index in the particle store of the first particle of this series
+    int32 ParticleStoreOffset = 0;
+
+    // Number of particles of this series in the particle store, not including duplicates
+    int32 ParticleStoreNum = 0;
+
+    // Features the substeps of this series are specialised for, chosen once when the simulation begins
+    uint32 SubstepFeatures = 0;
+
+    /*
+    * Makes this series a view over the particles of its segments in the given store
+    * The store must hold the model that owns the segments, at the given index in the store
+    */
+    void BindParticleStore(FTetherSimulationParticleStore& InParticleStore, int32 ModelIndex = 0);
+
+    bool IsBoundToParticleStore() const { return ParticleStore != nullptr; }
+
+    /*
+    * Tethers each free particle of the series to the nearest fixed particle along the cable, using the fixed particles of the bound particle store
+    * Must be called after binding to a particle store, and before any particles sleep
+    */
+    void BuildTethers();
+
+    bool HasTethers() const { return Tethers.IsValid(); }
+    const FTetherSimulationSegmentSeriesTethers& GetTethers() const { return *Tethers; }
+
+    /*
+    * Compiles the constraints of the series into a flat program, including its tethers if they have been built
+    * Must be called after binding to a particle store
+    */
+    void BuildConstraintProgram(bool bEnableStiffness, bool bUseStartTangent, bool bUseEndTangent);
+
+    bool HasConstraintProgram() const { return ConstraintProgram.IsValid(); }
+
+    /*
+    * Rebuilds the particles of every segment of the series if any of them was invalidated
+    * When warm starting and every segment has simulated before, the rebuilt particles are moved onto the previous shape of the series, leaving only the settle window at the end of the simulation duration to simulate
+    * If any segment can't be resampled, the whole series simulates from its rebuilt particles instead
+    * @param   BuildParticles  Rebuilds the particles of a segment from its spline
+    * @param   bOutWarmStarted True if the series was warm started
+    * @return  True if the series was rebuilt
+    */
+    bool RebuildInvalidatedSegments(TFunctionRef<void(FTetherSimulationSegment&)> BuildParticles, const FTetherCableSimulationOptions& SimulationOptions, bool bWarmStart, bool& bOutWarmStarted);
+    FTetherSimulationConstraintProgram& GetConstraintProgram() const { return *ConstraintProgram; }
+
     virtual int32 GetNumSegments() const override;
     virtual FTetherSimulationSegment* GetSegment(int32 SegmentIndex) override;
     virtual const FTetherSimulationSegment* GetSegmentConst(int32 SegmentIndex) const override;
+
+private:
+
+    // Shared so that copying a series stays cheap
+    TSharedPtr<const FTetherSimulationSegmentSeriesTethers> Tethers;
+
+    // Shared so that copying a series stays cheap, and copies made while simulating keep the inverse masses of the program up to date
+    TSharedPtr<FTetherSimulationConstraintProgram> ConstraintProgram;
 };
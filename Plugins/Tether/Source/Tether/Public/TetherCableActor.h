@@ -16,6 +16,7 @@
 
 #if WITH_EDITOR
 #include "Mesh/TetherAsyncMeshBuildTask.h"
+#include "Simulation/TetherSimulationContext.h"
 #endif
 
 #include "TetherCableActor.generated.h"
@@ -269,6 +270,13 @@ private:
 
 	bool bBuildAfterNextSimulation = false;
 
+	// Collision around the cable, copied for a previous simulation
+	TSharedPtr<const struct FTetherCollisionSnapshot, ESPMode::ThreadSafe> CollisionSnapshot;
+
+	// Particle store and temporaries of synchronous simulations, kept so each tick of a synchronous realtime simulation reuses the allocations of the last
+	FTetherSimulationParticleStore SynchronousParticleStore;
+	FTetherSimulationScratch SynchronousScratch;
+
 	/**
 	*  Updates the number of simulation segments to match the number of guide spline segments
 	*  Returns true if modified
@@ -295,6 +303,9 @@ private:
 
 	bool PrepareForSimulation(FTetherSimulationModel& InitialModel, FTetherSimulationParams& Params);
 
+	// Gives the params a snapshot of the collision around the model, reusing the last one if nothing around the cable has changed since it was taken
+	void UpdateCollisionSnapshot(const FTetherSimulationModel& Model, FTetherSimulationParams& Params);
+
 	FTetherSimulationResultInfo PerformSimulation(FTetherSimulationModel& InitialModel, float DeltaTime, bool bIgnoreSegmentsSimulatingAsync, EMeshBuildInstruction BuildMesh, bool bVerboseLogging);
 
 	bool PerformAsyncSimulation(FTetherSimulationModel& InitialModel, float DeltaTime, bool bOnlySimulateInvalidatedSegments, EMeshBuildInstruction BuildMesh, FOnTetherAsyncSimulationCompleteDelegate CompleteCallback = FOnTetherAsyncSimulationCompleteDelegate());
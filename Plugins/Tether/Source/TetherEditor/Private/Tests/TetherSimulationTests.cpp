@@ -1,14 +1,57 @@
 // Copyright Sam Bonifacio 2021. All Rights Reserved.
 
 #include "CoreTypes.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/AutomationTest.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Simulation/TetherCollisionSnapshot.h"
 #include "Simulation/TetherSimulation.h"
+#include "Simulation/TetherSimulationContext.h"
+#include "Simulation/TetherSimulationConstraintProgram.h"
 #include "Simulation/TetherSimulationInstanceResources.h"
 #include "Simulation/TetherSimulationModel.h"
 #include "Simulation/TetherSimulationParams.h"
+#include "Simulation/TetherSimulationParticleStore.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
+// Builds a single segment cable between two points, with particles every 10 units
+void MakeTestCable(FTetherSimulationModel& OutModel, const FVector& StartLocation = FVector::ZeroVector, const FVector& EndLocation = FVector(1000.f, 0.f, 0.f), float Length = 1200.f)
+{
+	OutModel.UpdateNumSegments(1);
+	OutModel.Segments[0].SplineSegmentInfo.StartLocation = StartLocation;
+	OutModel.Segments[0].SplineSegmentInfo.EndLocation = EndLocation;
+	OutModel.Segments[0].Length = Length;
+	OutModel.Segments[0].BuildParticles(10.f);
+}
+
+// Spawns a box which blocks everything, for cables to collide with
+UBoxComponent* SpawnTestBlock(UWorld* World, const FVector& BoxExtent, const FVector& Location)
+{
+	AActor* BlockActor = World->SpawnActor<AActor>();
+	UBoxComponent* Block = NewObject<UBoxComponent>(BlockActor);
+	Block->SetBoxExtent(BoxExtent);
+	Block->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	BlockActor->SetRootComponent(Block);
+	Block->RegisterComponent();
+	Block->SetWorldLocation(Location);
+	return Block;
+}
+
+// Tests each particle location matches the expected location within the tolerance
+void TestParticleLocationsEqual(FAutomationTestBase* Test, const TArray<FVector>& Locations, const TArray<FVector>& ExpectedLocations, float Tolerance = KINDA_SMALL_NUMBER)
+{
+	if(Test->TestEqual(TEXT("Number of particles must match"), Locations.Num(), ExpectedLocations.Num()))
+	{
+		for(int32 i = 0; i < ExpectedLocations.Num(); i++)
+		{
+			Test->TestEqual(FString::Printf(TEXT("Particle %i location must match"), i), Locations[i], ExpectedLocations[i], Tolerance);
+		}
+	}
+}
+
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationBasicTest, "Tether.Standard.Simulation.Basic Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
 
 bool FTetherSimulationBasicTest::RunTest(const FString& Parameters)
@@ -17,11 +60,7 @@ bool FTetherSimulationBasicTest::RunTest(const FString& Parameters)
 	World->CreatePhysicsScene();
 	
 	FTetherSimulationModel Model;
-	Model.UpdateNumSegments(1);
-	Model.Segments[0].SplineSegmentInfo.StartLocation = FVector::ZeroVector;
-	Model.Segments[0].SplineSegmentInfo.EndLocation = FVector(1000.f, 0.f ,0.f);
-	Model.Segments[0].Length = 1200.f;
-	Model.Segments[0].BuildParticles(10.f);
+	MakeTestCable(Model);
 
 	FTetherSimulationParams Params;
 	Params.World = World;
@@ -39,28 +78,1186 @@ bool FTetherSimulationBasicTest::RunTest(const FString& Parameters)
 	return true;
 }
 
-void RunSimulationPerfTest(const FAutomationTestBase* Test, float SimulationDuration)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationVectorizedIntegrationTest, "Tether.Standard.Simulation.Vectorized Integration Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationVectorizedIntegrationTest::RunTest(const FString& Parameters)
 {
-	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*Test->GetTestName()), nullptr, false);
+	IConsoleVariable* VectorizedIntegrationCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Tether.VectorizedIntegration"));
+	if(!TestNotNull(TEXT("Vectorized integration console variable must exist"), VectorizedIntegrationCVar))
+	{
+		return false;
+	}
+	const int32 PreviousValue = VectorizedIntegrationCVar->GetInt();
+
+	// Simulate the same cable with the scalar and vectorized integration, they should produce the same result
+	// Without drag both do exactly the same arithmetic, with drag the scalar integration finds the speed in single precision
+	for(const bool bDrag : { false, true })
+	{
+		TArray<FVector> Results[2];
+		for(int32 bVectorized = 0; bVectorized < 2; bVectorized++)
+		{
+			VectorizedIntegrationCVar->Set(bVectorized, ECVF_SetByCode);
+
+			FTetherSimulationModel Model;
+			MakeTestCable(Model);
+
+			FTetherSimulationParams Params;
+			Params.SimulationOptions.SimulationDuration = 1.f;
+			Params.SimulationOptions.bEnableCollision = false;
+			if(!bDrag)
+			{
+				Params.SimulationOptions.Drag = 0.f;
+			}
+
+			FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+			Results[bVectorized] = Model.GetParticleLocations();
+		}
+
+		TestParticleLocationsEqual(this, Results[1], Results[0], bDrag ? 0.001f : KINDA_SMALL_NUMBER);
+	}
+
+	VectorizedIntegrationCVar->Set(PreviousValue, ECVF_SetByCode);
+
+	return true;
+}
+
+// Average relative error of the distance between neighbouring particles
+float GetAverageStretchError(const FTetherSimulationSegment& Segment)
+{
+	const float ParticleSegmentLength = Segment.GetParticleSegmentLength();
+	float TotalError = 0.f;
+	for(int32 i = 0; i < Segment.Particles.Num() - 1; i++)
+	{
+		const float Distance = FVector::Dist(Segment.Particles[i].Position, Segment.Particles[i + 1].Position);
+		TotalError += FMath::Abs(Distance - ParticleSegmentLength) / ParticleSegmentLength;
+	}
+	return Segment.Particles.Num() > 1 ? TotalError / (Segment.Particles.Num() - 1) : 0.f;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationColouredSolverTest, "Tether.Standard.Simulation.Coloured Solver Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationColouredSolverTest::RunTest(const FString& Parameters)
+{
+	// Compare how well constraints converge using each solver, for the same number of iterations
+	for(const int32 NumIterations : { 1, 4, 8 })
+	{
+		float StretchErrors[2];
+		for(const ETetherConstraintSolver Solver : { ETetherConstraintSolver::Sequential, ETetherConstraintSolver::Coloured })
+		{
+			FTetherSimulationModel Model;
+			MakeTestCable(Model);
+
+			FTetherSimulationParams Params;
+			Params.SimulationOptions.SimulationDuration = 1.f;
+			Params.SimulationOptions.bEnableCollision = false;
+			Params.SimulationOptions.StiffnessSolverIterations = NumIterations;
+			Params.SimulationOptions.ConstraintSolver = Solver;
+
+			FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+
+			StretchErrors[(int32)Solver] = GetAverageStretchError(Model.Segments[0]);
+		}
+
+		const float SequentialError = StretchErrors[(int32)ETetherConstraintSolver::Sequential];
+		const float ColouredError = StretchErrors[(int32)ETetherConstraintSolver::Coloured];
+		AddInfo(FString::Printf(TEXT("%i iterations: sequential stretch error %f, coloured stretch error %f"), NumIterations, SequentialError, ColouredError));
+
+		TestTrue(FString::Printf(TEXT("Coloured solver must converge comparably to sequential solver with %i iterations"), NumIterations), ColouredError <= 2.f * SequentialError + 0.01f);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationDirectSolverTest, "Tether.Standard.Simulation.Direct Solver Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationDirectSolverTest::RunTest(const FString& Parameters)
+{
+	// A single direct solve per substep should stretch a long cable no more than several sequential iterations
+	float StretchErrors[2];
+	for(const ETetherConstraintSolver Solver : { ETetherConstraintSolver::Sequential, ETetherConstraintSolver::Direct })
+	{
+		const int32 ResultIdx = Solver == ETetherConstraintSolver::Direct;
+
+		FTetherSimulationModel Model;
+		MakeTestCable(Model, FVector::ZeroVector, FVector(10000.f, 0.f, 0.f), 12000.f);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 2.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.StiffnessSolverIterations = 8;
+		Params.SimulationOptions.ConstraintSolver = Solver;
+
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+
+		StretchErrors[ResultIdx] = GetAverageStretchError(Model.Segments[0]);
+	}
+
+	AddInfo(FString::Printf(TEXT("Sequential stretch error %f, direct stretch error %f"), StretchErrors[0], StretchErrors[1]));
+	TestTrue(TEXT("Direct solver must stretch no more than sequential solver"), StretchErrors[1] <= StretchErrors[0] + 0.01f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationImplicitIntegratorTest, "Tether.Standard.Simulation.Implicit Integrator Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationImplicitIntegratorTest::RunTest(const FString& Parameters)
+{
+	// With substeps many times longer than Verlet integration normally uses, the implicit integrator should hold a hanging cable closer to its length than Verlet integration does
+	// Both are followed by the same constraint solve, so any improvement comes from the implicit step
+	float StretchErrors[2];
+	for(int32 bImplicit = 0; bImplicit < 2; bImplicit++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 4.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.SubstepTime = 0.025f;
+		Params.SimulationOptions.Integrator = bImplicit ? ETetherIntegrator::Implicit : ETetherIntegrator::Verlet;
+
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		StretchErrors[bImplicit] = GetAverageStretchError(Model.Segments[0]);
+
+		const bool bValid = !Model.GetParticleLocations().ContainsByPredicate([](const FVector& Location) { return Location.ContainsNaN(); });
+		if(bImplicit)
+		{
+			TestTrue(TEXT("Implicit particle locations must be valid"), bValid);
+		}
+		else if(!bValid)
+		{
+			// Verlet integration blowing up at this substep counts as stretching without limit
+			StretchErrors[bImplicit] = MAX_flt;
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("Verlet stretch error %f, implicit stretch error %f"), StretchErrors[0], StretchErrors[1]));
+	TestTrue(TEXT("Implicit integrator must stretch less than Verlet integration with the same substep"), StretchErrors[1] < StretchErrors[0]);
+	TestTrue(TEXT("Implicit integrator must keep the cable close to its length"), StretchErrors[1] < 0.02f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationLocalSpaceSolverTest, "Tether.Standard.Simulation.Local Space Solver Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationLocalSpaceSolverTest::RunTest(const FString& Parameters)
+{
+	// Far from the world origin, solving in single precision relative to the cable must stay close to solving in double precision world space
+	const FVector CableStart = FVector(200000.f, -150000.f, 5000.f);
+	for(const ETetherConstraintSolver Solver : { ETetherConstraintSolver::Sequential, ETetherConstraintSolver::Coloured, ETetherConstraintSolver::Direct })
+	{
+		TArray<FVector> Results[2];
+		for(int32 bLocalSpace = 0; bLocalSpace < 2; bLocalSpace++)
+		{
+			FTetherSimulationModel Model;
+			MakeTestCable(Model, CableStart, CableStart + FVector(1000.f, 0.f, 0.f));
+
+			FTetherSimulationParams Params;
+			Params.SimulationOptions.SimulationDuration = 1.f;
+			Params.SimulationOptions.bEnableCollision = false;
+			Params.SimulationOptions.ConstraintSolver = Solver;
+			Params.SimulationOptions.bEnableLocalSpaceSolver = bLocalSpace > 0;
+
+			FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+			Results[bLocalSpace] = Model.GetParticleLocations();
+		}
+
+		if(!TestEqual(TEXT("Number of particles must match"), Results[1].Num(), Results[0].Num()))
+		{
+			continue;
+		}
+
+		float MaxDifference = 0.f;
+		for(int32 i = 0; i < Results[0].Num(); i++)
+		{
+			MaxDifference = FMath::Max<float>(MaxDifference, FVector::Dist(Results[0][i], Results[1][i]));
+		}
+		AddInfo(FString::Printf(TEXT("Solver %i: largest difference between local space and world space particles %f"), (int32)Solver, MaxDifference));
+		TestTrue(FString::Printf(TEXT("Solver %i: local space particles must be within tolerance of world space particles"), (int32)Solver), MaxDifference < 1.f);
+		TestEqual(TEXT("Fixed start particle must not move"), Results[1][0], Results[0][0]);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationCollisionSnapshotTest, "Tether.Standard.Simulation.Collision Snapshot Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationCollisionSnapshotTest::RunTest(const FString& Parameters)
+{
+	// A floor made of a grid of triangles, and an upright capsule standing on it
+	FTetherCollisionSnapshot Snapshot;
+	const float CellSize = 100.f;
+	for(int32 X = -10; X < 10; X++)
+	{
+		for(int32 Y = -10; Y < 10; Y++)
+		{
+			const FVector Corner(X * CellSize, Y * CellSize, 0.f);
+			Snapshot.AddTriangle(Corner, Corner + FVector(CellSize, 0.f, 0.f), Corner + FVector(CellSize, CellSize, 0.f), 0);
+			Snapshot.AddTriangle(Corner, Corner + FVector(CellSize, CellSize, 0.f), Corner + FVector(0.f, CellSize, 0.f), 0);
+		}
+	}
+	Snapshot.AddCapsule(FVector(0.f, 300.f, 50.f), FVector(0.f, 300.f, 200.f), 20.f, 1);
+	Snapshot.BuildHierarchy();
+	TestTrue(TEXT("Snapshot must be valid once built"), Snapshot.IsValid());
+
+	const float Radius = 10.f;
+	TArray<FHitResult> Hits;
+
+	// Falling onto the floor anywhere on the grid lands exactly one radius above it
+	for(const FVector& Point : { FVector(-950.f, -950.f, 0.f), FVector(123.f, -456.f, 0.f), FVector(950.f, 950.f, 0.f) })
+	{
+		Hits.Reset();
+		if(TestTrue(TEXT("Sweep down must hit the floor"), Snapshot.SweepSphere(Hits, Point + FVector(0.f, 0.f, 100.f), Point - FVector(0.f, 0.f, 100.f), Radius)))
+		{
+			TestEqual(TEXT("Floor must only be hit once"), Hits.Num(), 1);
+			TestFalse(TEXT("Sweep down must not start penetrating"), Hits[0].bStartPenetrating);
+			TestEqual(TEXT("Sweep down must stop a radius above the floor"), Hits[0].Location, Point + FVector(0.f, 0.f, Radius), 0.01f);
+			TestEqual(TEXT("Floor normal must point up"), Hits[0].Normal, FVector::UpVector, 0.001f);
+			TestEqual(TEXT("Floor must be hit at the right time"), Hits[0].Time, 0.45f, 0.001f);
+		}
+	}
+
+	// Starting inside the floor pushes back out of it
+	Hits.Reset();
+	if(TestTrue(TEXT("Sweep from within the floor must hit"), Snapshot.SweepSphere(Hits, FVector(10.f, 10.f, 4.f), FVector(10.f, 10.f, -4.f), Radius)))
+	{
+		TestTrue(TEXT("Sweep from within the floor must start penetrating"), Hits[0].bStartPenetrating);
+		TestEqual(TEXT("Penetration depth must be the overlap with the floor"), Hits[0].PenetrationDepth, Radius - 4.f, 0.01f);
+		TestEqual(TEXT("Penetration normal must point up"), Hits[0].Normal, FVector::UpVector, 0.001f);
+	}
+
+	// Sweeping sideways into the capsule stops against its side
+	Hits.Reset();
+	if(TestTrue(TEXT("Sweep into the capsule must hit"), Snapshot.SweepSphere(Hits, FVector(-100.f, 300.f, 100.f), FVector(100.f, 300.f, 100.f), Radius)))
+	{
+		TestEqual(TEXT("Capsule must only be hit once"), Hits.Num(), 1);
+		TestEqual(TEXT("Sweep must stop against the side of the capsule"), Hits[0].Location, FVector(-30.f, 300.f, 100.f), 0.01f);
+		TestEqual(TEXT("Capsule normal must point back along the sweep"), Hits[0].Normal, FVector(-1.f, 0.f, 0.f), 0.001f);
+	}
+
+	// Passing over the top of the capsule, or beyond the edge of the floor, hits nothing
+	Hits.Reset();
+	TestFalse(TEXT("Sweep over the capsule must not hit"), Snapshot.SweepSphere(Hits, FVector(-100.f, 300.f, 250.f), FVector(100.f, 300.f, 250.f), Radius));
+	TestFalse(TEXT("Sweep beyond the floor must not hit"), Snapshot.SweepSphere(Hits, FVector(1100.f, 0.f, 100.f), FVector(1100.f, 0.f, -100.f), Radius));
+	TestEqual(TEXT("Missed sweeps must not add hits"), Hits.Num(), 0);
+
+	// Sweeps are only covered by the snapshot within the bounds of what it copied
+	TestTrue(TEXT("Sweep over the floor must be within the snapshot"), Snapshot.Contains(FVector(0.f, 0.f, 100.f), FVector(100.f, 0.f, 100.f), Radius));
+	TestFalse(TEXT("Sweep beyond the floor must not be within the snapshot"), Snapshot.Contains(FVector(0.f, 0.f, 100.f), FVector(2000.f, 0.f, 100.f), Radius));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationDistanceFieldTest, "Tether.Standard.Simulation.Distance Field Collision Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationDistanceFieldTest::RunTest(const FString& Parameters)
+{
+	// The same floor and capsule as the collision snapshot test
+	FTetherCollisionSnapshot Snapshot;
+	const float GridSize = 100.f;
+	for(int32 X = -10; X < 10; X++)
+	{
+		for(int32 Y = -10; Y < 10; Y++)
+		{
+			const FVector Corner(X * GridSize, Y * GridSize, 0.f);
+			Snapshot.AddTriangle(Corner, Corner + FVector(GridSize, 0.f, 0.f), Corner + FVector(GridSize, GridSize, 0.f), 0);
+			Snapshot.AddTriangle(Corner, Corner + FVector(GridSize, GridSize, 0.f), Corner + FVector(0.f, GridSize, 0.f), 0);
+		}
+	}
+	Snapshot.AddCapsule(FVector(0.f, 300.f, 50.f), FVector(0.f, 300.f, 200.f), 20.f, 1);
+	Snapshot.BuildHierarchy();
+
+	const float CellSize = 5.f;
+	const float MaxDistance = 20.f;
+	Snapshot.BuildDistanceField(CellSize, MaxDistance);
+	const FTetherCollisionDistanceField& DistanceField = Snapshot.GetDistanceField();
+	TestTrue(TEXT("Distance field must be valid once built"), DistanceField.IsValid());
+	TestTrue(TEXT("Distance field must match the settings it was built with"), DistanceField.WasBuiltWith(CellSize, MaxDistance));
+	TestTrue(TEXT("Distance field must only store bricks near collision"), DistanceField.GetNumBricks() > 0 && DistanceField.GetNumBricks() < DistanceField.GetNumGridBricks());
+
+	float Distance;
+	FVector Normal;
+	int32 BodyIndex;
+
+	// Just above the floor, the distance is the height and the normal points up
+	if(TestTrue(TEXT("Sample just above the floor must be near collision"), DistanceField.Sample(FVector(123.f, -456.f, 7.f), Distance, Normal, BodyIndex)))
+	{
+		TestEqual(TEXT("Distance above the floor must be the height"), Distance, 7.f, 0.01f);
+		TestEqual(TEXT("Normal above the floor must point up"), Normal, FVector::UpVector, 0.001f);
+		TestEqual(TEXT("Nearest body above the floor must be the floor"), BodyIndex, 0);
+	}
+
+	// Beside the capsule, the normal points away from its axis
+	if(TestTrue(TEXT("Sample beside the capsule must be near collision"), DistanceField.Sample(FVector(-25.f, 300.f, 100.f), Distance, Normal, BodyIndex)))
+	{
+		TestEqual(TEXT("Distance beside the capsule must be to its surface"), Distance, 5.f, 1.f);
+		TestEqual(TEXT("Normal beside the capsule must point away from it"), Normal, FVector(-1.f, 0.f, 0.f), 0.01f);
+	}
+
+	// Below the side of the capsule, in a brick that also holds the floor, the nearest body is still the capsule
+	if(TestTrue(TEXT("Sample below the side of the capsule must be near collision"), DistanceField.Sample(FVector(-22.f, 300.f, 35.f), Distance, Normal, BodyIndex)))
+	{
+		TestEqual(TEXT("Nearest body below the side of the capsule must be the capsule"), BodyIndex, 1);
+	}
+
+	// Well clear of everything, or outside the snapshot, nothing is found
+	TestFalse(TEXT("Sample clear of collision must not be near collision"), DistanceField.Sample(FVector(-800.f, -800.f, 100.f), Distance, Normal, BodyIndex));
+	TestFalse(TEXT("Sample outside the snapshot must not be near collision"), DistanceField.Sample(FVector(2000.f, 0.f, 7.f), Distance, Normal, BodyIndex));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationDistanceFieldSweptComponentsTest, "Tether.Standard.Simulation.Distance Field Swept Components Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationDistanceFieldSweptComponentsTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
 	World->CreatePhysicsScene();
-	
+
+	// Two blocks under the cable, one of which has a tapered capsule that the snapshot can't copy, so it is swept individually as a landscape would be
+	UBoxComponent* CopiedBlock = SpawnTestBlock(World, FVector(100.f, 200.f, 50.f), FVector(500.f, 0.f, -150.f));
+	UBoxComponent* SweptBlock = SpawnTestBlock(World, FVector(100.f, 200.f, 50.f), FVector(200.f, 0.f, -150.f));
+	SweptBlock->GetBodySetup()->AggGeom.TaperedCapsuleElems.Add(FKTaperedCapsuleElem(1.f, 1.f, 1.f));
+
 	FTetherSimulationModel Model;
-	Model.UpdateNumSegments(1);
-	Model.Segments[0].SplineSegmentInfo.StartLocation = FVector::ZeroVector;
-	Model.Segments[0].SplineSegmentInfo.EndLocation = FVector(1000.f, 0.f ,0.f);
-	Model.Segments[0].Length = 1200.f;
-	Model.Segments[0].BuildParticles(10.f);
+	MakeTestCable(Model);
 
 	FTetherSimulationParams Params;
 	Params.World = World;
-	Params.SimulationOptions.SimulationDuration = SimulationDuration;
-	
+	Params.CollisionWidth = 10.f;
+	Params.SimulationOptions.SimulationDuration = 2.f;
+	Params.SimulationOptions.bEnableCollision = true;
+	Params.SimulationOptions.bEnableSelfCollision = false;
+	Params.SimulationOptions.CollisionMode = ETetherCollisionMode::DistanceField;
+
 	FTetherSimulationInstanceResources Resources;
 	Resources.InitializeResources(Model, Params);
-	
+
+	TSharedRef<FTetherCollisionSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FTetherCollisionSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Build(Params, FTetherCollisionSnapshot::GetSimulationBounds(Model, Params));
+	const float CellSize = Params.CollisionWidth * Params.SimulationOptions.DistanceFieldCellScale;
+	Snapshot->BuildDistanceField(CellSize, 0.5f * Params.CollisionWidth + 2.f * CellSize);
+	Params.CollisionSnapshot = Snapshot;
+
+	TestTrue(TEXT("Block with a tapered capsule must be swept individually"), Snapshot->HasSweptComponents());
+	TestTrue(TEXT("Distance field must be built from the copied block"), Snapshot->GetDistanceField().IsValid());
+
+	// Sweeping only the swept components must find the uncopied block and skip the copied one
+	const float Radius = 0.5f * Params.CollisionWidth;
+	TArray<FHitResult> Hits;
+	TestTrue(TEXT("Full sweep must hit the copied block"), Snapshot->SweepSphere(Hits, FVector(500.f, 0.f, 0.f), FVector(500.f, 0.f, -150.f), Radius));
+	Hits.Reset();
+	TestFalse(TEXT("Swept component sweep must not hit the copied block"), Snapshot->SweepSweptComponents(Hits, FVector(500.f, 0.f, 0.f), FVector(500.f, 0.f, -150.f), Radius));
+	if(TestTrue(TEXT("Swept component sweep must hit the uncopied block"), Snapshot->SweepSweptComponents(Hits, FVector(200.f, 0.f, 0.f), FVector(200.f, 0.f, -150.f), Radius)))
+	{
+		TestEqual(TEXT("Swept component sweep must only hit the uncopied block"), Hits.Num(), 1);
+		TestTrue(TEXT("Swept component hit must be with the uncopied block"), Hits[0].Component.Get() == SweptBlock);
+	}
+
+	// The cable must rest on both blocks, whether its particles are pushed out by the distance field or swept
+	const FTetherSimulationResultInfo Result = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+	TestTrue(TEXT("Cable must hit the blocks"), Result.NumCollisionHits > 0);
+	for(const FVector& Location : Model.GetParticleLocations())
+	{
+		for(const UBoxComponent* Block : { CopiedBlock, SweptBlock })
+		{
+			const FBox BlockBox = Block->Bounds.GetBox();
+			if(Location.X > BlockBox.Min.X && Location.X < BlockBox.Max.X)
+			{
+				TestTrue(TEXT("Particle must not sink into the block"), Location.Z > BlockBox.Max.Z + Radius - 1.f);
+			}
+		}
+	}
+
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationConstraintProgramTest, "Tether.Standard.Simulation.Constraint Program Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationConstraintProgramTest::RunTest(const FString& Parameters)
+{
+	FTetherSimulationModel Model;
+	MakeTestCable(Model);
+
+	FTetherSimulationParticleStore ParticleStore;
+	ParticleStore.Build(Model);
+	const int32 NumParticles = ParticleStore.Num();
+
+	// Hold both ends along tangents, so the chain gains a synthetic particle at either end
+	const FVector Tangent = FVector::ForwardVector;
+	FTetherSimulationConstraintProgram Program;
+	Program.Build(ParticleStore, 0, NumParticles, Model.Segments[0].Length / (NumParticles - 1), true, &Tangent, &Tangent, nullptr);
+
+	TestEqual(TEXT("Chain must include both synthetic particles"), Program.GetNumChainParticles(), NumParticles + 2);
+	TestEqual(TEXT("Synthetic start particle must be fixed"), Program.ChainInverseMasses[0], 0.f);
+	TestEqual(TEXT("Synthetic end particle must be fixed"), Program.ChainInverseMasses.Last(), 0.f);
+	TestEqual(TEXT("Every neighbouring pair of chain particles must have a stretch constraint"), Program.NumStretchConstraints, NumParticles + 1);
+	TestEqual(TEXT("Every other pair of chain particles must have a stiffness constraint"), Program.Constraints.Num() - Program.NumStretchConstraints, NumParticles);
+	TestEqual(TEXT("Coloured constraints must contain every constraint"), Program.ColouredConstraints.Num(), Program.Constraints.Num());
+	TestEqual(TEXT("Stretch and stiffness constraints must each need only two colours"), Program.GetNumColours(), 4);
+
+	for(int32 Colour = 0; Colour < Program.GetNumColours(); Colour++)
+	{
+		TSet<int32> ColourParticles;
+		for(int32 i = Program.ColourOffsets[Colour]; i < Program.ColourOffsets[Colour + 1]; i++)
+		{
+			bool bAlreadyInSetA = false;
+			bool bAlreadyInSetB = false;
+			ColourParticles.Add(Program.ColouredConstraints.IndicesA[i], &bAlreadyInSetA);
+			ColourParticles.Add(Program.ColouredConstraints.IndicesB[i], &bAlreadyInSetB);
+			TestFalse(FString::Printf(TEXT("Constraints of colour %i must not share particles"), Colour), bAlreadyInSetA || bAlreadyInSetB);
+		}
+	}
+
+	// Putting a particle to sleep must stop constraints moving it
+	const int32 SleepingIdx = NumParticles / 2;
+	ParticleStore.SetSleeping(SleepingIdx, true);
+	Program.UpdateInverseMasses(ParticleStore);
+	for(int32 i = 0; i < Program.Constraints.Num(); i++)
+	{
+		if(Program.Constraints.IndicesA[i] == SleepingIdx + 1)
+		{
+			TestEqual(TEXT("Sleeping particle must have zero inverse mass in its constraints"), Program.Constraints.InverseMassesA[i], 0.f);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationComplianceTest, "Tether.Standard.Simulation.Compliance Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationComplianceTest::RunTest(const FString& Parameters)
+{
+	// Inextensible compliant constraints with fewer iterations and larger substeps should stretch no more than the default solver
+	float StretchErrors[2];
+	for(int32 bCompliant = 0; bCompliant < 2; bCompliant++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 1.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		if(bCompliant)
+		{
+			Params.SimulationOptions.bEnableCompliance = true;
+			Params.SimulationOptions.StretchCompliance = 0.f;
+			Params.SimulationOptions.StiffnessSolverIterations = 2;
+			Params.SimulationOptions.SubstepTime *= 2.f;
+		}
+
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+
+		StretchErrors[bCompliant] = GetAverageStretchError(Model.Segments[0]);
+	}
+
+	AddInfo(FString::Printf(TEXT("Default stretch error %f, compliant stretch error %f"), StretchErrors[0], StretchErrors[1]));
+	TestTrue(TEXT("Compliant constraints must stretch no more than default constraints"), StretchErrors[1] <= StretchErrors[0] + 0.01f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationTetherConstraintsTest, "Tether.Standard.Simulation.Tether Constraints Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationTetherConstraintsTest::RunTest(const FString& Parameters)
+{
+	// A long cable with a single solver iteration stretches a long way, tethers should hold it to its length
+	float StretchErrors[2];
+	for(int32 bTethers = 0; bTethers < 2; bTethers++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model, FVector::ZeroVector, FVector(10000.f, 0.f, 0.f), 12000.f);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 2.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.StiffnessSolverIterations = 1;
+		Params.SimulationOptions.ConstraintsEaseInTime = 0.f;
+		Params.SimulationOptions.bEnableTethers = bTethers > 0;
+
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+
+		StretchErrors[bTethers] = GetAverageStretchError(Model.Segments[0]);
+
+		if(bTethers)
+		{
+			const FTetherSimulationSegment& Segment = Model.Segments[0];
+			const int32 LastIdx = Segment.Particles.Num() - 1;
+			const float ParticleSegmentLength = Segment.GetParticleSegmentLength();
+			for(int32 i = 1; i < LastIdx; i++)
+			{
+				const float MaxDistance = FMath::Min(i, LastIdx - i) * ParticleSegmentLength;
+				const float AnchorDistance = FMath::Min(FVector::Dist(Segment.Particles[i].Position, Segment.Particles[0].Position), FVector::Dist(Segment.Particles[i].Position, Segment.Particles[LastIdx].Position));
+				TestTrue(FString::Printf(TEXT("Particle %i must be within cable length of its anchor"), i), AnchorDistance <= MaxDistance + 1.f);
+			}
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("Stretch error without tethers %f, with tethers %f"), StretchErrors[0], StretchErrors[1]));
+	TestTrue(TEXT("Tethers must reduce stretch"), StretchErrors[1] < StretchErrors[0]);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationRestDetectionTest, "Tether.Standard.Simulation.Rest Detection Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationRestDetectionTest::RunTest(const FString& Parameters)
+{
+	// Simulate with and without rest detection, a settled cable should stop early and end up in the same place
+	TArray<FVector> Results[2];
+	FTetherSimulationResultInfo ResultInfos[2];
+	for(int32 bRestDetection = 0; bRestDetection < 2; bRestDetection++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 20.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.bEnableRestDetection = bRestDetection > 0;
+
+		ResultInfos[bRestDetection] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Results[bRestDetection] = Model.GetParticleLocations();
+
+		TestEqual(TEXT("Segment must be simulated for the full duration"), Model.Segments[0].SimulationTime, Params.SimulationOptions.SimulationDuration, 0.01f);
+	}
+
+	AddInfo(FString::Printf(TEXT("Settled at %f"), ResultInfos[1].SettledTime));
+	TestEqual(TEXT("Series must settle"), ResultInfos[1].NumSettledSeries, 1);
+	TestTrue(TEXT("Series must settle before the full duration"), ResultInfos[1].SettledTime > 0.f && ResultInfos[1].SettledTime < 20.f);
+	TestEqual(TEXT("Series must not settle without rest detection"), ResultInfos[0].NumSettledSeries, 0);
+
+	TestParticleLocationsEqual(this, Results[1], Results[0], 5.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationParticleSleepingTest, "Tether.Standard.Simulation.Particle Sleeping Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationParticleSleepingTest::RunTest(const FString& Parameters)
+{
+	// Simulate with and without sleeping, particles of a hanging cable should fall asleep without changing its shape
+	TArray<FVector> Results[2];
+	FTetherSimulationResultInfo ResultInfos[2];
+	for(int32 bSleeping = 0; bSleeping < 2; bSleeping++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 10.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.bEnableParticleSleeping = bSleeping > 0;
+
+		ResultInfos[bSleeping] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Results[bSleeping] = Model.GetParticleLocations();
+	}
+
+	AddInfo(FString::Printf(TEXT("%i of %i particles sleeping"), ResultInfos[1].NumSleepingParticles, Results[1].Num()));
+	TestEqual(TEXT("No particles must sleep when sleeping is disabled"), ResultInfos[0].NumSleepingParticles, 0);
+	TestTrue(TEXT("Particles must sleep when sleeping is enabled"), ResultInfos[1].NumSleepingParticles > 0);
+
+	TestParticleLocationsEqual(this, Results[1], Results[0], 5.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationAdaptiveSubstepTest, "Tether.Standard.Simulation.Adaptive Substep Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationAdaptiveSubstepTest::RunTest(const FString& Parameters)
+{
+	// Simulate with fixed substeps, then twice with adaptive substeps
+	// Adaptive substeps should reach the same shape, and produce exactly the same result each time
+	TArray<FVector> Results[3];
+	for(int32 RunIdx = 0; RunIdx < 3; RunIdx++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.SimulationOptions.SimulationDuration = 10.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.bEnableAdaptiveSubstepping = RunIdx > 0;
+
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Results[RunIdx] = Model.GetParticleLocations();
+
+		TestEqual(TEXT("Segment must be simulated for the full duration"), Model.Segments[0].SimulationTime, Params.SimulationOptions.SimulationDuration, 0.01f);
+	}
+
+	TestParticleLocationsEqual(this, Results[1], Results[0], 10.f);
+	TestParticleLocationsEqual(this, Results[2], Results[1], 0.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationWarmStartTest, "Tether.Standard.Simulation.Warm Start Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationWarmStartTest::RunTest(const FString& Parameters)
+{
+	FTetherSimulationParams Params;
+	Params.SimulationOptions.bEnableCollision = false;
+	Params.SimulationOptions.bEnableWarmStart = true;
+	const FTetherCableSimulationOptions& Options = Params.SimulationOptions;
+
+	TestTrue(TEXT("Warm start must be used when enabled"), Options.ShouldUseWarmStart(false));
+	TestFalse(TEXT("Warm start must not be used while simulating in realtime"), Options.ShouldUseWarmStart(true));
+
+	// Rebuilds the particles of a segment from its spline, as the cable actor does
+	auto BuildParticles = [](FTetherSimulationSegment& Segment)
+	{
+		Segment.BuildParticles(10.f);
+	};
+
+	// Settle a cable, then nudge its end point and add some slack
+	FTetherSimulationModel PreviousModel;
+	MakeTestCable(PreviousModel);
+	FTetherSimulation::PerformSimulation(PreviousModel, 0.f, Params, nullptr);
+
+	FTetherSimulationModel ModifiedModel = PreviousModel;
+	ModifiedModel.Segments[0].SplineSegmentInfo.EndLocation = FVector(1000.f, 50.f ,0.f);
+	ModifiedModel.Segments[0].Length = 1250.f;
+	ModifiedModel.Segments[0].SetInvalidated(true);
+
+	// Simulate the modified cable from the spline, as when simulating in realtime, and warm started from the previous shape
+	FTetherSimulationModel ColdModel = ModifiedModel;
+	FTetherProxySimulationSegmentSeries ColdSeries;
+	ColdSeries.Segments.Add(&ColdModel.Segments[0]);
+	bool bWarmStarted = true;
+	TestTrue(TEXT("Invalidated series must be rebuilt"), ColdSeries.RebuildInvalidatedSegments(BuildParticles, Options, Options.ShouldUseWarmStart(true), bWarmStarted));
+	TestFalse(TEXT("Series must not be warm started in realtime"), bWarmStarted);
+	TestEqual(TEXT("Series that isn't warm started must simulate from the start"), ColdModel.Segments[0].SimulationTime, 0.f);
+	FTetherSimulation::PerformSimulation(ColdModel, 0.f, Params, nullptr);
+
+	FTetherSimulationModel WarmModel = ModifiedModel;
+	FTetherProxySimulationSegmentSeries WarmSeries;
+	WarmSeries.Segments.Add(&WarmModel.Segments[0]);
+	TestTrue(TEXT("Invalidated series must be rebuilt"), WarmSeries.RebuildInvalidatedSegments(BuildParticles, Options, Options.ShouldUseWarmStart(false), bWarmStarted));
+	TestTrue(TEXT("Series must be warm started"), bWarmStarted);
+	TestEqual(TEXT("Resampled start must be at new start location"), WarmModel.Segments[0].Particles[0].Position, ModifiedModel.Segments[0].SplineSegmentInfo.StartLocation, 0.01f);
+	TestEqual(TEXT("Resampled end must be at new end location"), WarmModel.Segments[0].Particles.Last().Position, ModifiedModel.Segments[0].SplineSegmentInfo.EndLocation, 0.01f);
+	TestEqual(TEXT("Warm started series must only simulate the settle window"), WarmModel.Segments[0].SimulationTime, Options.SimulationDuration - Options.WarmStartSettleDuration);
+	const FTetherSimulationResultInfo WarmResult = FTetherSimulation::PerformSimulation(WarmModel, 0.f, Params, nullptr);
+
+	AddInfo(FString::Printf(TEXT("Warm start simulated %f seconds"), WarmResult.SimulatedTime));
+
+	const TArray<FVector> ColdResult = ColdModel.GetParticleLocations();
+	const TArray<FVector> WarmResultLocations = WarmModel.GetParticleLocations();
+	TestParticleLocationsEqual(this, WarmResultLocations, ColdResult, 10.f);
+
+	// A series of two segments where only the first was invalidated, which must rebuild both
+	FTetherSimulationModel SeriesModel;
+	SeriesModel.UpdateNumSegments(2);
+	SeriesModel.Segments[0].SplineSegmentInfo.StartLocation = FVector::ZeroVector;
+	SeriesModel.Segments[0].SplineSegmentInfo.EndLocation = FVector(500.f, 0.f ,0.f);
+	SeriesModel.Segments[0].Length = 600.f;
+	SeriesModel.Segments[1].SplineSegmentInfo.StartLocation = FVector(500.f, 0.f ,0.f);
+	SeriesModel.Segments[1].SplineSegmentInfo.EndLocation = FVector(1000.f, 0.f ,0.f);
+	SeriesModel.Segments[1].Length = 600.f;
+	for(FTetherSimulationSegment& Segment : SeriesModel.Segments)
+	{
+		Segment.BuildParticles(10.f);
+	}
+	SeriesModel.Segments[0].SimulationTime = Options.SimulationDuration;
+	SeriesModel.Segments[0].SetInvalidated(true);
+	FTetherSimulationModel SplineModel = SeriesModel;
+
+	// A segment that has never simulated has no previous shape to start from, so the series isn't warm started
+	{
+		FTetherSimulationModel Model = SeriesModel;
+		Model.Segments[0].Particles[1].Position += FVector(0.f, 0.f, -10.f);
+		FTetherProxySimulationSegmentSeries Series;
+		Series.Segments = { &Model.Segments[0], &Model.Segments[1] };
+		TestTrue(TEXT("Series with an invalidated segment must be rebuilt"), Series.RebuildInvalidatedSegments(BuildParticles, Options, true, bWarmStarted));
+		TestFalse(TEXT("Series with a segment that has never simulated must not be warm started"), bWarmStarted);
+		TestEqual(TEXT("Series that isn't warm started must simulate from the start"), Model.Segments[0].SimulationTime, 0.f);
+		TestEqual(TEXT("Series that isn't warm started must start from the spline"), Model.Segments[0].Particles[1].Position, SplineModel.Segments[0].Particles[1].Position, 0.01f);
+	}
+
+	// A segment whose rebuilt particles can't be resampled makes the whole series fall back to starting from the spline
+	{
+		FTetherSimulationModel Model = SeriesModel;
+		Model.Segments[0].Particles[1].Position += FVector(0.f, 0.f, -10.f);
+		Model.Segments[1].SimulationTime = Options.SimulationDuration;
+		Model.Segments[1].SplineSegmentInfo.EndLocation = Model.Segments[1].SplineSegmentInfo.StartLocation;
+		FTetherProxySimulationSegmentSeries Series;
+		Series.Segments = { &Model.Segments[0], &Model.Segments[1] };
+		TestTrue(TEXT("Series with an invalidated segment must be rebuilt"), Series.RebuildInvalidatedSegments(BuildParticles, Options, true, bWarmStarted));
+		TestFalse(TEXT("Series with a segment that can't be resampled must not be warm started"), bWarmStarted);
+		TestEqual(TEXT("Series that falls back must simulate from the start"), Model.Segments[0].SimulationTime, 0.f);
+		TestEqual(TEXT("Series that falls back must start from the spline"), Model.Segments[0].Particles[1].Position, SplineModel.Segments[0].Particles[1].Position, 0.01f);
+	}
+
+	// Nothing is rebuilt when nothing was invalidated
+	{
+		FTetherSimulationModel Model = SeriesModel;
+		Model.Segments[0].SetInvalidated(false);
+		Model.Segments[1].SimulationTime = Options.SimulationDuration;
+		FTetherProxySimulationSegmentSeries Series;
+		Series.Segments = { &Model.Segments[0], &Model.Segments[1] };
+		TestFalse(TEXT("Series without an invalidated segment must not be rebuilt"), Series.RebuildInvalidatedSegments(BuildParticles, Options, true, bWarmStarted));
+		TestFalse(TEXT("Series that isn't rebuilt must not be warm started"), bWarmStarted);
+		TestEqual(TEXT("Series that isn't rebuilt must keep its simulated time"), Model.Segments[0].SimulationTime, Options.SimulationDuration);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationCatenaryPlacementTest, "Tether.Standard.Simulation.Catenary Placement Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationCatenaryPlacementTest::RunTest(const FString& Parameters)
+{
+	const FVector CableForce(0.f, 0.f, -980.f);
+
+	FTetherSimulationModel Model;
+	MakeTestCable(Model, FVector::ZeroVector, FVector(1000.f, 0.f, 300.f), 1400.f);
+
+	FTetherSimulationSegment& Segment = Model.Segments[0];
+	const FVector StartLocation = Segment.Particles[0].Position;
+	const FVector EndLocation = Segment.Particles.Last().Position;
+	if(!TestTrue(TEXT("Particles must be placed on catenary"), Segment.PlaceParticlesOnCatenary(CableForce)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Start particle must not move"), Segment.Particles[0].Position, StartLocation);
+	TestEqual(TEXT("End particle must not move"), Segment.Particles.Last().Position, EndLocation);
+	TestTrue(TEXT("Catenary particles must be evenly spaced along the cable length"), GetAverageStretchError(Segment) < 0.01f);
+
+	float LowestZ = 0.f;
+	for(const FTetherSimulationParticle& Particle : Segment.Particles)
+	{
+		LowestZ = FMath::Min(LowestZ, (float)Particle.Position.Z);
+	}
+	TestTrue(TEXT("Cable must sag below its lowest end point"), LowestZ < -100.f);
+
+	// Starting at equilibrium, the cable should barely move while simulating
+	const TArray<FVector> InitialLocations = Model.GetParticleLocations();
+
+	FTetherSimulationParams Params;
+	Params.CableForce = CableForce;
+	Params.SimulationOptions.SimulationDuration = 0.5f;
+	Params.SimulationOptions.bEnableCollision = false;
+	Params.SimulationOptions.bEnableStiffness = false;
+	Params.SimulationOptions.ConstraintsEaseInTime = 0.f;
+	FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+
+	const TArray<FVector> SimulatedLocations = Model.GetParticleLocations();
+	float MaxMovement = 0.f;
+	for(int32 i = 0; i < SimulatedLocations.Num(); i++)
+	{
+		MaxMovement = FMath::Max(MaxMovement, (float)FVector::Dist(SimulatedLocations[i], InitialLocations[i]));
+	}
+	AddInfo(FString::Printf(TEXT("Max movement from catenary %f"), MaxMovement));
+	TestTrue(TEXT("Cable placed on catenary must start close to rest"), MaxMovement < 10.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationAnalyticSolveTest, "Tether.Standard.Simulation.Analytic Solve Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationAnalyticSolveTest::RunTest(const FString& Parameters)
+{
+	FTetherSimulationModel Model;
+	MakeTestCable(Model, FVector::ZeroVector, FVector(1000.f, 0.f, 300.f), 1400.f);
+
+	FTetherSimulationModel CatenaryModel = Model;
+	CatenaryModel.Segments[0].PlaceParticlesOnCatenary(FVector(0.f, 0.f, -980.f));
+
+	FTetherSimulationParams Params;
+	Params.CableForce = FVector(0.f, 0.f, -980.f);
+	Params.SimulationOptions.bEnableCollision = false;
+	Params.SimulationOptions.bEnableStiffness = false;
+	Params.SimulationOptions.bEnableAnalyticSolve = true;
+
+	// Stiffness can't be solved in closed form, so must still be simulated
+	{
+		FTetherSimulationModel StiffModel = Model;
+		FTetherSimulationParams StiffParams = Params;
+		StiffParams.SimulationOptions.bEnableStiffness = true;
+		StiffParams.SimulationOptions.SimulationDuration = 0.1f;
+		const FTetherSimulationResultInfo Result = FTetherSimulation::PerformSimulation(StiffModel, 0.f, StiffParams, nullptr);
+		TestFalse(TEXT("Stiff cable must not be solved analytically"), Result.bAnalytic);
+		TestTrue(TEXT("Stiff cable must be simulated"), Result.NumSubsteps > 0);
+	}
+
 	const FTetherSimulationResultInfo Result = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+	TestTrue(TEXT("Hanging cable must be solved analytically"), Result.bAnalytic);
+	TestEqual(TEXT("Analytic segments"), Result.AnalyticSegments, Result.SimulatedSegments);
+	TestEqual(TEXT("No substeps must be simulated"), Result.NumSubsteps, 0);
+	TestEqual(TEXT("Segment must be fully simulated"), Model.Segments[0].SimulationTime, Params.SimulationOptions.SimulationDuration);
+
+	const TArray<FVector> Locations = Model.GetParticleLocations();
+	const TArray<FVector> CatenaryLocations = CatenaryModel.GetParticleLocations();
+	TestParticleLocationsEqual(this, Locations, CatenaryLocations, 0.01f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationAllocationFreeSubstepTest, "Tether.Standard.Simulation.Allocation Free Substep Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationAllocationFreeSubstepTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// A floor under the whole cable for it to fall onto, built by hand so sweeps never leave the snapshot for the physics scene
+	// The capsule beside the cable only extends the snapshot upwards, so it covers the whole fall
+	TSharedPtr<FTetherCollisionSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FTetherCollisionSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->AddTriangle(FVector(-1000.f, -1000.f, -100.f), FVector(2000.f, -1000.f, -100.f), FVector(2000.f, 1000.f, -100.f), 0);
+	Snapshot->AddTriangle(FVector(-1000.f, -1000.f, -100.f), FVector(2000.f, 1000.f, -100.f), FVector(-1000.f, 1000.f, -100.f), 0);
+	Snapshot->AddCapsule(FVector(-900.f, -900.f, -100.f), FVector(-900.f, -900.f, 500.f), 10.f, 1);
+	Snapshot->BuildHierarchy();
+
+	// Simulating more substeps must not grow the particle store, the scratch space or the hit components any further than simulating one,
+	// so everything the substeps use is allocated setting up the simulation
+	// With collision, the longer simulation also hits the floor, which the shorter one doesn't reach
+	for(int32 bCollision = 0; bCollision < 2; bCollision++)
+	{
+		SIZE_T AllocatedSizes[2];
+		FTetherSimulationResultInfo Results[2];
+		for(const int32 ResultIdx : { 0, 1 })
+		{
+			FTetherSimulationModel Model;
+			MakeTestCable(Model);
+
+			FTetherSimulationParams Params;
+			Params.SimulationOptions.bEnableCollision = bCollision > 0;
+			Params.SimulationOptions.bEnableSelfCollision = false;
+			Params.SimulationOptions.bEnableStiffness = true;
+			Params.SimulationOptions.SimulationDuration = (ResultIdx == 0 ? 1.5f : 300.5f) * Params.SimulationOptions.SubstepTime;
+			if(bCollision)
+			{
+				Params.World = World;
+				Params.CollisionWidth = 10.f;
+				Params.CollisionSnapshot = Snapshot;
+			}
+
+			FTetherSimulationParticleStore ParticleStore;
+			FTetherSimulationScratch Scratch;
+			Results[ResultIdx] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, ParticleStore, Scratch, nullptr);
+			AllocatedSizes[ResultIdx] = ParticleStore.GetAllocatedSize() + Scratch.GetAllocatedSize() + Results[ResultIdx].HitComponents.GetAllocatedSize();
+		}
+
+		const TCHAR* CaseName = bCollision ? TEXT("With collision") : TEXT("Without collision");
+		AddInfo(FString::Printf(TEXT("%s: %i substeps: %llu bytes, %i substeps: %llu bytes"), CaseName, Results[0].NumSubsteps, (uint64)AllocatedSizes[0], Results[1].NumSubsteps, (uint64)AllocatedSizes[1]));
+		TestTrue(FString::Printf(TEXT("%s: Longer simulation must simulate more substeps"), CaseName), Results[1].NumSubsteps > Results[0].NumSubsteps);
+		if(bCollision)
+		{
+			TestEqual(TEXT("With collision: Shorter simulation must not reach the floor"), Results[0].NumCollisionHits, 0);
+			TestTrue(TEXT("With collision: Longer simulation must hit the floor"), Results[1].NumCollisionHits > 0);
+		}
+		TestTrue(FString::Printf(TEXT("%s: Substeps must not allocate"), CaseName), AllocatedSizes[1] == AllocatedSizes[0]);
+	}
+
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationParallelSeriesTest, "Tether.Standard.Simulation.Parallel Series Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationParallelSeriesTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// Every anchor is fixed, so each segment is its own series and simulating them in parallel must give the same result as one after another
+	constexpr int32 NumSegments = 4;
+	TArray<FVector> Locations[2];
+	FTetherSimulationResultInfo Results[2];
+	for(int32 bParallel = 0; bParallel < 2; bParallel++)
+	{
+		FTetherSimulationModel Model;
+		FTetherSimulationParams Params;
+		Model.UpdateNumSegments(NumSegments);
+		Params.SegmentParams.SetNum(NumSegments + 1);
+		for(int32 i = 0; i < NumSegments; i++)
+		{
+			Params.SegmentParams[i].SimulationOptions.bFixedAnchorPoint = true;
+			Model.Segments[i].SplineSegmentInfo.StartLocation = FVector(1000.f * i, 0.f, 0.f);
+			Model.Segments[i].SplineSegmentInfo.EndLocation = FVector(1000.f * (i + 1), 0.f, 100.f * i);
+			Model.Segments[i].Length = 1100.f + 100.f * i;
+			Model.Segments[i].BuildParticles(10.f, true, true);
+		}
+		Params.SegmentParams.Last().bShouldSimulateSegment = false;
+		Params.World = World;
+		Params.SimulationOptions.SimulationDuration = 1.f;
+		Params.SimulationOptions.bEnableCollision = false;
+		Params.SimulationOptions.bEnableParallelSeries = bParallel > 0;
+
+		FTetherSimulationInstanceResources Resources;
+		Resources.InitializeResources(Model, Params);
+
+		Results[bParallel] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Locations[bParallel] = Model.GetParticleLocations();
+	}
+
+	World->DestroyWorld(false);
+
+	TestFalse(TEXT("Sequential simulation must not run series in parallel"), Results[0].bParallelSeries);
+	TestTrue(TEXT("Series must be simulated in parallel"), Results[1].bParallelSeries);
+	TestEqual(TEXT("Number of substeps must match"), Results[1].NumSubsteps, Results[0].NumSubsteps);
+	TestTrue(TEXT("Simulated segments must match"), Results[1].SimulatedSegments == Results[0].SimulatedSegments);
+	TestParticleLocationsEqual(this, Locations[1], Locations[0]);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationBatchedCollisionQueriesTest, "Tether.Standard.Simulation.Batched Collision Queries Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationBatchedCollisionQueriesTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// A block under the middle of the cable for it to sag onto
+	SpawnTestBlock(World, FVector(100.f, 200.f, 50.f), FVector(500.f, 0.f, -150.f));
+
+	// Sweeping each particle against the bodies found by one overlap must find the same hits as sweeping each through the scene
+	TArray<FVector> Locations[2];
+	FTetherSimulationResultInfo Results[2];
+	for(int32 bBatched = 0; bBatched < 2; bBatched++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.World = World;
+		Params.CollisionWidth = 10.f;
+		Params.SimulationOptions.SimulationDuration = 1.f;
+		Params.SimulationOptions.bEnableCollision = true;
+		Params.SimulationOptions.bEnableSelfCollision = false;
+		Params.SimulationOptions.bEnableBatchedCollisionQueries = bBatched > 0;
+
+		FTetherSimulationInstanceResources Resources;
+		Resources.InitializeResources(Model, Params);
+
+		Results[bBatched] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Locations[bBatched] = Model.GetParticleLocations();
+	}
+
+	World->DestroyWorld(false);
+
+	TestTrue(TEXT("Cable must hit the block"), Results[0].NumCollisionHits > 0);
+	TestEqual(TEXT("Number of collision hits must match"), Results[1].NumCollisionHits, Results[0].NumCollisionHits);
+	TestParticleLocationsEqual(this, Locations[1], Locations[0], 0.1f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationCollisionCullingTest, "Tether.Standard.Simulation.Collision Culling Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationCollisionCullingTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// A block under the middle of the cable, so some particles come to rest on it while the rest hang clear of everything
+	SpawnTestBlock(World, FVector(100.f, 200.f, 50.f), FVector(500.f, 0.f, -150.f));
+
+	// Culled sweeps are only those that couldn't have hit anything, so culling must not change the result
+	TArray<FVector> Locations[2];
+	FTetherSimulationResultInfo Results[2];
+	for(int32 bCulling = 0; bCulling < 2; bCulling++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.World = World;
+		Params.CollisionWidth = 10.f;
+		Params.SimulationOptions.SimulationDuration = 1.f;
+		Params.SimulationOptions.bEnableCollision = true;
+		Params.SimulationOptions.bEnableSelfCollision = false;
+		Params.SimulationOptions.bEnableCollisionCulling = bCulling > 0;
+
+		FTetherSimulationInstanceResources Resources;
+		Resources.InitializeResources(Model, Params);
+
+		Results[bCulling] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Locations[bCulling] = Model.GetParticleLocations();
+	}
+
+	World->DestroyWorld(false);
+
+	TestTrue(TEXT("Cable must hit the block"), Results[0].NumCollisionHits > 0);
+	TestEqual(TEXT("No sweeps must be culled without culling"), Results[0].NumCulledCollisionSweeps, 0);
+	TestTrue(TEXT("Sweeps of particles clear of the block must be culled"), Results[1].NumCulledCollisionSweeps > 0);
+	TestEqual(TEXT("Every sweep must be either performed or culled"), Results[1].NumCollisionSweeps + Results[1].NumCulledCollisionSweeps, Results[0].NumCollisionSweeps);
+	TestEqual(TEXT("Number of collision hits must match"), Results[1].NumCollisionHits, Results[0].NumCollisionHits);
+	TestParticleLocationsEqual(this, Locations[1], Locations[0]);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationContactCachingTest, "Tether.Standard.Simulation.Contact Caching Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationContactCachingTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// A flat block under the middle of the cable for particles to rest on
+	SpawnTestBlock(World, FVector(100.f, 200.f, 50.f), FVector(500.f, 0.f, -150.f));
+
+	// Colliding resting particles with the plane of the block's top must replace sweeps without changing where they rest
+	TArray<FVector> Locations[2];
+	FTetherSimulationResultInfo Results[2];
+	for(int32 bCaching = 0; bCaching < 2; bCaching++)
+	{
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.World = World;
+		Params.CollisionWidth = 10.f;
+		Params.SimulationOptions.SimulationDuration = 2.f;
+		Params.SimulationOptions.bEnableCollision = true;
+		Params.SimulationOptions.bEnableSelfCollision = false;
+		Params.SimulationOptions.bEnableContactCaching = bCaching > 0;
+
+		FTetherSimulationInstanceResources Resources;
+		Resources.InitializeResources(Model, Params);
+
+		Results[bCaching] = FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		Locations[bCaching] = Model.GetParticleLocations();
+	}
+
+	World->DestroyWorld(false);
+
+	TestTrue(TEXT("Cable must hit the block"), Results[0].NumCollisionHits > 0);
+	TestEqual(TEXT("No contacts must be cached without caching"), Results[0].NumCachedContactHits, 0);
+	TestTrue(TEXT("Resting particles must hit their cached contacts"), Results[1].NumCachedContactHits > 0);
+	TestTrue(TEXT("Cached contacts must replace sweeps"), Results[1].NumCollisionSweeps < Results[0].NumCollisionSweeps);
+	TestParticleLocationsEqual(this, Locations[1], Locations[0], 1.f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationBatchTest, "Tether.Standard.Simulation.Batch Test", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FTetherSimulationBatchTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// Short cables of different lengths and settings, simulated alone and then as one batch, must give the same result
+	// The first two cables share their substeps despite their different stiffness, while the others can't be batched with any other cable
+	constexpr int32 NumCables = 4;
+	FTetherSimulationModel Models[2][NumCables];
+	FTetherSimulationParams Params[NumCables];
+	TArray<FTetherSimulationInstanceResources> Resources;
+	Resources.SetNum(NumCables);
+	for(int32 i = 0; i < NumCables; i++)
+	{
+		for(int32 bBatched = 0; bBatched < 2; bBatched++)
+		{
+			FTetherSimulationModel& Model = Models[bBatched][i];
+			Model.UpdateNumSegments(1);
+			Model.Segments[0].SplineSegmentInfo.StartLocation = FVector(0.f, 500.f * i, 0.f);
+			Model.Segments[0].SplineSegmentInfo.EndLocation = FVector(100.f + 100.f * i, 500.f * i, 0.f);
+			Model.Segments[0].Length = 150.f + 100.f * i;
+			Model.Segments[0].BuildParticles(10.f);
+		}
+		Params[i].World = World;
+		Params[i].SimulationOptions.SimulationDuration = 0.5f;
+		Params[i].SimulationOptions.bEnableStiffness = i == 1;
+		Params[i].SimulationOptions.bEnableAdaptiveSubstepping = i == 2;
+		if(i == 3)
+		{
+			Params[i].SimulationOptions.Drag *= 2.f;
+		}
+		Resources[i].InitializeResources(Models[0][i], Params[i]);
+	}
+
+	FTetherSimulationResultInfo AloneResults[NumCables];
+	for(int32 i = 0; i < NumCables; i++)
+	{
+		AloneResults[i] = FTetherSimulation::PerformSimulation(Models[0][i], 0.f, Params[i], nullptr);
+	}
+
+	TArray<FTetherSimulationModel*> BatchModels;
+	TArray<const FTetherSimulationParams*> BatchParams;
+	for(int32 i = 0; i < NumCables; i++)
+	{
+		BatchModels.Add(&Models[1][i]);
+		BatchParams.Add(&Params[i]);
+	}
+	const TArray<FTetherSimulationResultInfo> BatchResults = FTetherSimulation::PerformBatchSimulation(BatchModels, BatchParams, 0.f, nullptr);
 
 	World->DestroyWorld(false);
+
+	if(!TestEqual(TEXT("Batch must give a result for each cable"), BatchResults.Num(), NumCables))
+	{
+		return true;
+	}
+
+	for(int32 i = 0; i < NumCables; i++)
+	{
+		TestTrue(FString::Printf(TEXT("Cable %i must only be batched if it shares its substeps with another cable"), i), BatchResults[i].bBatched == (i < 2));
+		TestFalse(FString::Printf(TEXT("Cable %i simulated alone must not be batched"), i), AloneResults[i].bBatched);
+		TestEqual(FString::Printf(TEXT("Cable %i number of substeps must match"), i), BatchResults[i].NumSubsteps, AloneResults[i].NumSubsteps);
+		TestEqual(FString::Printf(TEXT("Cable %i simulated time must match"), i), BatchResults[i].SimulatedTime, AloneResults[i].SimulatedTime);
+		const TArray<FVector> AloneLocations = Models[0][i].GetParticleLocations();
+		const TArray<FVector> BatchLocations = Models[1][i].GetParticleLocations();
+		if(TestEqual(FString::Printf(TEXT("Cable %i number of particles must match"), i), BatchLocations.Num(), AloneLocations.Num()))
+		{
+			for(int32 j = 0; j < AloneLocations.Num(); j++)
+			{
+				TestEqual(FString::Printf(TEXT("Cable %i particle %i location must match"), i, j), BatchLocations[j], AloneLocations[j]);
+			}
+		}
+	}
+
+	return true;
+}
+
+// Simulates a cable for the given duration, once with debugging compiled into every substep and once with the specialised substeps, and reports the time taken by each
+void RunSimulationPerfTest(FAutomationTestBase* Test, float SimulationDuration)
+{
+	IConsoleVariable* SubstepDebugCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Tether.SubstepDebug"));
+	if(!Test->TestNotNull(TEXT("Substep debug console variable must exist"), SubstepDebugCVar))
+	{
+		return;
+	}
+	const int32 PreviousValue = SubstepDebugCVar->GetInt();
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*Test->GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	double ElapsedTimes[2];
+	TArray<FVector> Results[2];
+	for(int32 bSpecialised = 0; bSpecialised < 2; bSpecialised++)
+	{
+		SubstepDebugCVar->Set(bSpecialised ? 0 : 1, ECVF_SetByCode);
+
+		FTetherSimulationModel Model;
+		MakeTestCable(Model);
+
+		FTetherSimulationParams Params;
+		Params.World = World;
+		Params.SimulationOptions.SimulationDuration = SimulationDuration;
+		
+		FTetherSimulationInstanceResources Resources;
+		Resources.InitializeResources(Model, Params);
+
+		const double StartTime = FPlatformTime::Seconds();
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		ElapsedTimes[bSpecialised] = FPlatformTime::Seconds() - StartTime;
+		Results[bSpecialised] = Model.GetParticleLocations();
+	}
+
+	SubstepDebugCVar->Set(PreviousValue, ECVF_SetByCode);
+
+	World->DestroyWorld(false);
+
+	Test->AddInfo(FString::Printf(TEXT("Debug substeps: %f s, specialised substeps: %f s (%.2fx faster)"), ElapsedTimes[0], ElapsedTimes[1], ElapsedTimes[0] / FMath::Max(ElapsedTimes[1], SMALL_NUMBER)));
+
+	// Debugging must not change the result
+	TestParticleLocationsEqual(Test, Results[1], Results[0]);
 }
 
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationPerformanceTest100Seconds, "Tether.Performance.Simulation.Performance Test 100 Seconds", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
@@ -79,4 +1276,69 @@ bool FTetherSimulationPerformanceTest500Seconds::RunTest(const FString& Paramete
 	return true;
 }
 
+// Builds a model spanning the same distance and length regardless of how many segments it is split into, joined with free anchor points
+void MakeMultiSegmentModel(int32 NumSegments, FTetherSimulationModel& OutModel, FTetherSimulationParams& OutParams)
+{
+	const FVector CableStart = FVector::ZeroVector;
+	const FVector CableEnd = FVector(4000.f, 0.f, 0.f);
+	const float CableLength = 4800.f;
+
+	OutModel.UpdateNumSegments(NumSegments);
+	OutParams.SegmentParams.SetNum(NumSegments + 1);
+	for(int32 i = 0; i < NumSegments; i++)
+	{
+		const bool bStartFixed = i == 0;
+		const bool bEndFixed = i == NumSegments - 1;
+		OutParams.SegmentParams[i].SimulationOptions.bFixedAnchorPoint = bStartFixed;
+		OutModel.Segments[i].SplineSegmentInfo.StartLocation = FMath::Lerp(CableStart, CableEnd, (float)i / NumSegments);
+		OutModel.Segments[i].SplineSegmentInfo.EndLocation = FMath::Lerp(CableStart, CableEnd, (float)(i + 1) / NumSegments);
+		OutModel.Segments[i].Length = CableLength / NumSegments;
+		OutModel.Segments[i].BuildParticles(10.f, bStartFixed, bEndFixed);
+	}
+	OutParams.SegmentParams.Last().bShouldSimulateSegment = false;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTetherSimulationPerformanceTestSegmentCount, "Tether.Performance.Simulation.Performance Test Segment Count", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTetherSimulationPerformanceTestSegmentCount::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, FName(*GetTestName()), nullptr, false);
+	World->CreatePhysicsScene();
+
+	// The same cable is split into more and more segments, so cost per particle per substep should stay flat
+	double BaselineSubstepParticleTime = 0.;
+	for(const int32 NumSegments : { 1, 8, 32, 128 })
+	{
+		FTetherSimulationModel Model;
+		FTetherSimulationParams Params;
+		MakeMultiSegmentModel(NumSegments, Model, Params);
+		Params.World = World;
+		Params.SimulationOptions.SimulationDuration = 1.f;
+		Params.SimulationOptions.bEnableCollision = false;
+
+		FTetherSimulationInstanceResources Resources;
+		Resources.InitializeResources(Model, Params);
+
+		const int32 NumParticles = Model.GetNumParticles();
+		const int32 NumSubsteps = Params.SimulationOptions.SimulationDuration / Params.SimulationOptions.SubstepTime;
+
+		const double StartTime = FPlatformTime::Seconds();
+		FTetherSimulation::PerformSimulation(Model, 0.f, Params, nullptr);
+		const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+		const double SubstepParticleTime = ElapsedTime / (NumSubsteps * NumParticles);
+		if(BaselineSubstepParticleTime <= 0.)
+		{
+			BaselineSubstepParticleTime = SubstepParticleTime;
+		}
+
+		AddInfo(FString::Printf(TEXT("%i segments, %i particles: %f ms per substep, %f ns per particle per substep (%.2fx single segment)"),
+			NumSegments, NumParticles, 1000. * ElapsedTime / NumSubsteps, 1000000000. * SubstepParticleTime, SubstepParticleTime / BaselineSubstepParticleTime));
+	}
+
+	World->DestroyWorld(false);
+
+	return true;
+}
+
 #endif